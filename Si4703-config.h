@@ -0,0 +1,81 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This file holds the compile-time configuration of the library. The Arduino
+ * IDE compiles libraries on their own, so a #define in the sketch does not
+ * reach them: edit the defaults below, or pass -D flags through the build
+ * properties (e.g. arduino-cli compile --build-property
+ * "compiler.cpp.extra_flags=-DSI4703_FEATURE_RDS=0"). Settings of the helper
+ * modules (SI4703_TRANSPORT, SI4703_TELEMETRY_SIZE, SI4703_PRESETS_*,
+ * SI4703_SCHEDULER_SIZE, SI4703_AF_SIZE) may be defined here as well, as this
+ * file is read before their headers.
+ */
+
+#ifndef _SI4703_CONFIG_H_INCLUDED
+#define _SI4703_CONFIG_H_INCLUDED
+
+//Features, 1 to build them in, 0 to leave them out. The SRAM figures are per
+//Si4703 object on the AVR, see the README for the flash ones.
+//RDS reception: readRDSGroup(), getClockTime() and friends. 140 bytes of
+//SRAM, more with a larger SI4703_RDS_RING_SIZE.
+#ifndef SI4703_FEATURE_RDS
+# define SI4703_FEATURE_RDS 1
+#endif
+//Command processor: setProperty(), getProperty() and batching. 37 bytes of
+//SRAM. With RDS gone as well, RDSA..RDSD leave the register shadow, saving
+//another 8 bytes.
+#ifndef SI4703_FEATURE_COMMANDS
+# define SI4703_FEATURE_COMMANDS 1
+#endif
+//Interrupt mode: without it begin() always polls. 11 bytes of SRAM, plus 9
+//shared by all objects.
+#ifndef SI4703_FEATURE_INTERRUPTS
+# define SI4703_FEATURE_INTERRUPTS 1
+#endif
+//Extended volume range: volumeUp()/volumeDown() go through the 15 quieter
+//steps of VOLEXT below the normal range.
+#ifndef SI4703_FEATURE_VOLEXT
+# define SI4703_FEATURE_VOLEXT 1
+#endif
+
+//How many Si4703 objects can be in interrupt mode at the same time, at most 4
+#ifndef SI4703_MAX_INSTANCES
+# define SI4703_MAX_INSTANCES 2
+#endif
+#if SI4703_MAX_INSTANCES < 1 || SI4703_MAX_INSTANCES > 4
+# error SI4703_MAX_INSTANCES must be between 1 and 4
+#endif
+
+//Define to 1 to have the driver count where its time and bus traffic go,
+//see Si4703::getStats(); off by default as it costs 133 bytes of SRAM per
+//Si4703 and slows every register access down a little.
+#ifndef SI4703_INSTRUMENTATION
+# define SI4703_INSTRUMENTATION 0
+#endif
+
+//Depth of the RDS group ring filled by the ISR, must be a power of two. One
+//slot is always kept free, so the ring holds SI4703_RDS_RING_SIZE - 1 groups;
+//trades SRAM (13 bytes per slot) for tolerance to slow loop() iterations.
+#ifndef SI4703_RDS_RING_SIZE
+# define SI4703_RDS_RING_SIZE 8
+#endif
+#if SI4703_RDS_RING_SIZE < 2 || \
+    (SI4703_RDS_RING_SIZE & (SI4703_RDS_RING_SIZE - 1))
+# error SI4703_RDS_RING_SIZE must be a power of two
+#endif
+
+//How many property values set getProperty() remembers, 4 bytes each
+#ifndef SI4703_PROPERTY_CACHE_SIZE
+# define SI4703_PROPERTY_CACHE_SIZE 4
+#endif
+#if SI4703_PROPERTY_CACHE_SIZE < 1
+# error SI4703_PROPERTY_CACHE_SIZE must be at least 1
+#endif
+
+#endif
@@ -14,7 +14,69 @@
 #ifndef _SI4703_PRIVATE_H_INCLUDED
 #define _SI4703_PRIVATE_H_INCLUDED
 
+#include "Si4703.h"
+
 //Define Si4703 I2C Address
 #define SI4703_I2C_ADDR (0x20 >> 1)
 
+//Older cores lack the means to map pins to interrupt numbers
+#ifndef NOT_AN_INTERRUPT
+# define NOT_AN_INTERRUPT -1
+#endif
+#ifndef digitalPinToInterrupt
+# define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : \
+                                  NOT_AN_INTERRUPT))
+#endif
+//...or to pin change interrupts, so there will be none
+#ifndef digitalPinToPCICR
+# define digitalPinToPCICR(p) ((volatile uint8_t *)0)
+# define digitalPinToPCICRbit(p) 0
+# define digitalPinToPCMSK(p) ((volatile uint8_t *)0)
+# define digitalPinToPCMSKbit(p) 0
+#endif
+
+//No such slot in the interrupt dispatch table
+#define SI4703_NO_SLOT 0xFF
+
+//How long RDSR stays up after a group has been received, in microseconds
+#define SI4703_RDSR_MICROS 40000UL
+
+//How long the command processor may take to come up or to carry out a
+//command before we give up on it, in microseconds
+#define SI4703_COMMAND_MICROS 50000UL
+
+//Instrumentation hooks, compiled out unless asked for, see Si4703_Stats
+#if SI4703_INSTRUMENTATION
+/*
+* Description:
+*   Accounts bus traffic to op for as long as it is in scope, unless an
+*   outer scope already claimed it (or force is given, as for interrupts).
+*/
+class Si4703_OpScope
+{
+    public:
+        Si4703_OpScope(volatile byte &current, byte op, bool force = false)
+            : _current(current), _saved(current) {
+            if(force || _saved == SI4703_OP_NONE) _current = op; };
+        ~Si4703_OpScope() { _current = _saved; };
+
+    private:
+        volatile byte &_current;
+        const byte _saved;
+};
+
+# define SI4703_OP(op) Si4703_OpScope _opScope(_op, op)
+# define SI4703_COUNT(counter) (_stats.counter++)
+# define SI4703_COUNT_TRANSFER(count) countTransfer(count)
+#else
+# define SI4703_OP(op)
+# define SI4703_COUNT(counter)
+# define SI4703_COUNT_TRANSFER(count)
+#endif
+
+//Power-up sequence timings from the datasheet, in microseconds
+#define SI4703_RESET_MICROS 100UL
+#define SI4703_XOSC_MICROS 500000UL
+#define SI4703_POWERUP_MICROS 110000UL
+
 #endif
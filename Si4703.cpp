@@ -1,352 +1,1226 @@
-/* Arduino Si4703 (and family) Library
- * See the README file for author and licensing information. In case it's
- * missing from your distribution, use the one here as the authoritative
- * version: https://github.com/csdexter/Si4703/blob/master/README
- *
- * This library is for use with the SparkFun Si4703 Evaluation or Breakout
- * Boards.
- * See the example sketches to learn how to use the library in your code.
- *
- * This is the main code file for the library.
- * See the header file for better function documentation.
- */
-
-#include "Si4703.h"
-#include "Si4703-private.h"
-
-#include <Wire.h>
-
-#include <string.h>
-
-#include <util/atomic.h>
-
-Si4703::Si4703(byte pinReset, byte pinGPIO2, byte pinSEN) {
-    _pinReset = pinReset;
-    _pinGPIO2 = pinGPIO2;
-    _pinSEN = pinSEN;
-}
-
-void Si4703::begin(byte band, bool xosc, bool interrupt) {
-    //Start by resetting the Si4703 and configuring the communication protocol
-    pinMode(_pinReset, OUTPUT);
-    pinMode(_pinSEN, OUTPUT);
-    //I2C mode, SCLK is always connected to SCL
-    pinMode(SCL, OUTPUT);
-
-    //Put the Si4703 in reset
-    digitalWrite(_pinReset, LOW);
-
-    //Configure for I2C mode; GPIO3 is pulled low by internal pull-down
-    digitalWrite(_pinSEN, HIGH);
-    //SCLK must be high until we start talking to the chip
-    digitalWrite(SCL, HIGH);
-
-    //Use the longest of delays given in the datasheet
-    delayMicroseconds(100);
-
-    //Bring the Si4703 out of reset
-    digitalWrite(_pinReset, HIGH);
-
-    //Datasheet calls for 30ns delay; an Arduino running at 20MHz (4MHz
-    //faster than the Uno, mind you) has a clock period of 50ns so no action
-    //needed.
-
-    //Calculate if interrupt mode was requested AND is possible
-    //TODO: this only works on the Uno and Mega, 'cause Arduino could not be
-    //arsed to give us a proper API (attachInterrupt() should take the pin
-    //number as an argument, not some opaque chip-dependent value! Moreover, it
-    //should not use external interrupts (scarce) but pin-change interrupts
-    //(plenty)).
-    _interrupt = interrupt && (_pinGPIO2 == 2 || _pinGPIO2 == 3);
-
-    //Configure GPIO2 for hardware interrupts
-    if(_interrupt) pinMode(_pinGPIO2, INPUT);
-
-    //Configure the I2C hardware
-    Wire.begin();
-
-    //Enable the crystal oscillator, if present
-    if(xosc) {
-        getRegisterBulk(true);
-        _registers[SI4703_REG_TEST1] |= SI4703_FLG_XOSCEN;
-        setRegisterBulk(true);
-        //Wait for the oscillator to stabilize.
-        delay(500);
-    };
-
-    //Cache the register file before powerup
-    getRegisterBulk(true);
-
-    //Ask the Si4703 to wake up
-    _registers[SI4703_REG_POWERCFG] |= (SI4703_FLG_DMUTE | SI4703_FLG_ENABLE);
-    setRegisterBulk();
-
-    //Wait for it to finish booting
-    delay(110);
-
-    //Cache the register file after powerup
-    getRegisterBulk(true);
-
-    //Configure the Si4703 for operation
-    _registers[SI4703_REG_POWERCFG] |= SI4703_FLG_RDSM;
-    _registers[SI4703_REG_SYSCONFIG1] |= SI4703_FLG_RDS | SI4703_FLG_DE;
-    if(_interrupt)
-        _registers[SI4703_REG_SYSCONFIG1] |= (
-            SI4703_FLG_RDSIEN | SI4703_FLG_STCIEN | SI4703_GPIO2_INT);
-    _registers[SI4703_REG_SYSCONFIG2] |= (
-        band | SI4703_SPACE_100K | SI4703_VOLUME_MASK);
-    _registers[SI4703_REG_SYSCONFIG3] |= ((1 << SI4703_SKSNR_SHIFT) | 0x1);
-    setRegisterBulk();
-
-    //The chip is alive and interrupts have been configured on its side, switch
-    //ourselves to interrupt operation if so requested and if wiring was
-    //properly done.
-    if (_interrupt) {
-      attachInterrupt(_pinGPIO2 == 2 ? 0 : 1, Si4703::interruptServiceRoutine,
-                      FALLING);
-      interrupts();
-    };
-}
-
-const byte Si4703_ChannelSpacings[3] PROGMEM = { 20, 10, 5 };
-
-word Si4703::getFrequency(void) {
-    getRegisterBulk();
-
-    return (
-        _registers[SI4703_REG_SYSCONFIG2] & SI4703_BAND_MASK ? 7600 : 8750) +
-        (_registers[SI4703_REG_READCHAN] & SI4703_READCHAN_MASK) *
-        pgm_read_byte(&Si4703_ChannelSpacings[
-            (_registers[SI4703_REG_SYSCONFIG2] & SI4703_SPACE_MASK) >> 4]);
-}
-
-void Si4703::seekUp(bool wrap) {
-    if(wrap)
-        _registers[SI4703_REG_POWERCFG] &= ~SI4703_FLG_SKMODE;
-    else
-        _registers[SI4703_REG_POWERCFG] |= SI4703_FLG_SKMODE;
-    _registers[SI4703_REG_POWERCFG] |= (SI4703_FLG_SEEKUP | SI4703_FLG_SEEK);
-    setRegisterBulk();
-
-    completeTune();
-}
-
-void Si4703::seekDown(bool wrap) {
-    if(wrap)
-        _registers[SI4703_REG_POWERCFG] &= ~SI4703_FLG_SKMODE;
-    else
-        _registers[SI4703_REG_POWERCFG] |= SI4703_FLG_SKMODE;
-    _registers[SI4703_REG_POWERCFG] &= ~SI4703_FLG_SEEKUP;
-    _registers[SI4703_REG_POWERCFG] |= SI4703_FLG_SEEK;
-    setRegisterBulk();
-
-    completeTune();
-}
-
-byte Si4703::getRSSI(void) {
-    getRegisterBulk();
-
-    return _registers[SI4703_REG_STATUSRSSI] & SI4703_RSSI_MASK;
-}
-
-bool Si4703::volumeUp(void) {
-    getRegisterBulk();
-
-    const byte volume = _registers[SI4703_REG_SYSCONFIG2] & SI4703_VOLUME_MASK;
-
-    if(volume == SI4703_VOLUME_MASK) {
-        if(!(_registers[SI4703_REG_SYSCONFIG3] & SI4703_FLG_VOLEXT))
-            return false;
-        else {
-            //Switch to the higher volume range
-            _registers[SI4703_REG_SYSCONFIG3] &= ~SI4703_FLG_VOLEXT;
-            _registers[SI4703_REG_SYSCONFIG2] =
-                _registers[SI4703_REG_SYSCONFIG2] & ~SI4703_VOLUME_MASK | 0x1;
-        };
-    } else {
-        _registers[SI4703_REG_SYSCONFIG2] = _registers[SI4703_REG_SYSCONFIG2] &
-                                            ~SI4703_VOLUME_MASK | (volume + 1);
-    };
-
-    setRegisterBulk();
-
-    return true;
-}
-
-bool Si4703::volumeDown(bool alsomute) {
-    getRegisterBulk();
-
-    const byte volume = _registers[SI4703_REG_SYSCONFIG2] & SI4703_VOLUME_MASK;
-
-    if(!volume)
-        return false;
-
-    if(volume == 1 && !(_registers[SI4703_REG_SYSCONFIG3] & SI4703_FLG_VOLEXT)) {
-        //Switch to lower volume range
-        _registers[SI4703_REG_SYSCONFIG3] |= SI4703_FLG_VOLEXT;
-        _registers[SI4703_REG_SYSCONFIG2] |= SI4703_VOLUME_MASK;
-    } else
-        _registers[SI4703_REG_SYSCONFIG2] = _registers[SI4703_REG_SYSCONFIG2] &
-                                            ~SI4703_VOLUME_MASK | (volume - 1);
-
-    setRegisterBulk();
-    if(!(volume - 1) && alsomute)
-        //If we are to trust the datasheet, this is superfluous as a volume
-        //of zero triggers mute on its own.
-        mute();
-    return true;
-}
-
-void Si4703::unMute(bool minvol) {
-    if(minvol)
-        _registers[SI4703_REG_SYSCONFIG2] = _registers[SI4703_REG_SYSCONFIG2] &
-                                            SI4703_VOLUME_MASK | 0x1;
-    _registers[SI4703_REG_POWERCFG] |= SI4703_FLG_DMUTE;
-
-    setRegisterBulk();
-}
-
-void Si4703::mute(void) {
-    _registers[SI4703_REG_POWERCFG] &= ~SI4703_FLG_DMUTE;
-
-    setRegisterBulk();
-};
-
-void Si4703::end(void) {
-    mute();
-    _registers[SI4703_REG_POWERCFG] |= SI4703_FLG_DISABLE;
-    _registers[SI4703_REG_SYSCONFIG1] &= ~SI4703_FLG_RDS;
-
-    setRegisterBulk();
-}
-
-void Si4703::sendCommand(byte command, byte arg0, byte arg1, byte arg2,
-                         byte arg3, byte arg4, byte arg5, byte arg6) {
-    const bool previousRDS = _registers[SI4703_REG_SYSCONFIG1] & SI4703_FLG_RDS;
-
-    //Enable command processor
-    _registers[SI4703_REG_SYSCONFIG1] &= ~SI4703_FLG_RDS;
-    _registers[SI4703_REG_RDSD] = word(0x00, SI4703_CMD_VERIFY_COMMAND);
-    setRegisterBulk(false, true);
-    //Wait for activation
-    while(_registers[SI4703_REG_RDSD])
-        getRegisterBulk();
-
-    //Send the command and its arguments
-    _registers[SI4703_REG_RDSA] = word(arg0, arg1);
-    _registers[SI4703_REG_RDSB] = word(arg2, arg3);
-    _registers[SI4703_REG_RDSC] = word(arg4, arg5);
-    _registers[SI4703_REG_RDSD] = word(arg6, command);
-    setRegisterBulk(false, true);
-
-    //Wait for processing
-    while(lowByte(_registers[SI4703_REG_RDSD]))
-        getRegisterBulk();
-    //Copy the (now valid) response bytes over as re-enabling RDS below may
-    //immediately trigger an interrupt which will clobber our data.
-    memcpy(_response, (void *)&_registers[SI4703_REG_RDSA], sizeof(_response));
-
-    //Restore previous RDS state
-    if(previousRDS) {
-        _registers[SI4703_REG_SYSCONFIG1] |= SI4703_FLG_RDS;
-        setRegisterBulk();
-    };
-};
-
-void Si4703::setProperty(word property, word value) {
-    sendCommand(SI4703_CMD_SET_PROPERTY, highByte(value), lowByte(value), 0, 0,
-                highByte(property), lowByte(property));
-}
-
-word Si4703::getProperty(word property) {
-    sendCommand(SI4703_CMD_GET_PROPERTY, 0, 0, 0, 0, highByte(property),
-                lowByte(property));
-
-    return _response[0];
-}
-
-bool Si4703::readRDSGroup(word* block) {
-    if(_haveRds) {
-        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-            memcpy(block, (void *)_rdsBlocks, sizeof(_rdsBlocks));
-            _haveRds = false;
-        }
-
-        return true;
-    } else
-        return false;
-};
-
-void Si4703::getRegisterBulk(bool all) {
-    const byte count = all ? SI4703_LAST_REGISTER : 6;
-
-    Wire.requestFrom(SI4703_I2C_ADDR, count * 2);
-
-    for(byte i = 0; i < count; i++) {
-        _registers[
-            (SI4703_FIRST_REGISTER_READ + i) & SI4703_LAST_REGISTER] =
-                (word)Wire.read() << 8;
-        _registers[
-            (SI4703_FIRST_REGISTER_READ + i) & SI4703_LAST_REGISTER] |=
-                Wire.read();
-    };
-};
-
-void Si4703::setRegisterBulk(bool test, bool cmd) {
-    Wire.beginTransmission(SI4703_I2C_ADDR);
-
-    for(byte i = 0; i < (cmd ? 14 : (test ? 6 : 5)); i++) {
-        Wire.write(highByte(_registers[SI4703_FIRST_REGISTER_WRITE + i]));
-        Wire.write(lowByte(_registers[SI4703_FIRST_REGISTER_WRITE + i]));
-    };
-
-    Wire.endTransmission();
-};
-
-void Si4703::waitForInterrupt(word which) {
-    while(!(_registers[SI4703_REG_STATUSRSSI] & which))
-        if(!_interrupt) {
-            if(which == SI4703_STATUS_STC)
-                //Give the chip a rest while it's seeking/tuning, according to
-                //datasheet recommendations.
-                delay(60);
-            getRegisterBulk();
-        };
-}
-
-void Si4703::completeTune(void) {
-    waitForInterrupt(SI4703_STATUS_STC);
-
-    //Clear RDS state
-    memset((void *)_rdsBlocks, 0x00, sizeof(_rdsBlocks));
-    _haveRds = false;
-
-    //Reset STC and SF/BL flags
-    _registers[SI4703_REG_POWERCFG] &= ~SI4703_FLG_SEEK;
-    setRegisterBulk();
-}
-
-void Si4703::interruptServiceRoutine(void) {
-    NONATOMIC_BLOCK(NONATOMIC_RESTORESTATE) {
-        //Most unfortunately, Wire is interrupt based
-        getRegisterBulk();
-    };
-
-    if(_registers[SI4703_REG_STATUSRSSI] & SI4703_STATUS_RDSR) {
-        //A future call to getRegisterBulk() may clobber the RDS group the chip
-        //is trying to give us righ now, so copy this one over if it's good
-        //enough to save.
-        if(!(_registers[SI4703_REG_STATUSRSSI] & SI4703_BLERA_MASK ||
-             _registers[SI4703_REG_READCHAN] & SI4703_BLERB_MASK ||
-             _registers[SI4703_REG_READCHAN] & SI4703_BLERC_MASK ||
-             _registers[SI4703_REG_READCHAN] & SI4703_BLERD_MASK)) {
-            memcpy((void *)_rdsBlocks, (void *)&_registers[SI4703_REG_RDSA],
-                   sizeof(_rdsBlocks));
-            _haveRds = true;
-        };
-    };
-}
-
-volatile word Si4703::_registers[] = {0x0000};
-volatile word Si4703::_rdsBlocks[] = {0x0000};
-volatile bool Si4703::_haveRds = false;
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the main code file for the library.
+ * See the header file for better function documentation.
+ */
+
+#include "Si4703.h"
+#include "Si4703-private.h"
+#include "Si4703Transport.h"
+#include "Si4703Telemetry.h"
+#include "Si4703Trace.h"
+
+#include <string.h>
+
+#include <util/atomic.h>
+
+Si4703::Si4703(byte pinReset, byte pinGPIO2, byte pinSEN) {
+    _pinReset = pinReset;
+    _pinGPIO2 = pinGPIO2;
+    _pinSEN = pinSEN;
+    _writeBytesSaved = 0;
+    _tuneState = SI4703_TUNE_IDLE;
+    _tuneFrequency = 0;
+    _tuneCallback = NULL;
+    _beginStage = SI4703_BEGIN_NONE;
+    _transaction = false;
+#if SI4703_FEATURE_COMMANDS
+    _commandBatch = false;
+    _commandLatency = 0;
+    _propertyCount = _propertyNext = 0;
+#endif
+    _interrupt = SI4703_INT_NONE;
+    _selector = NULL;
+    _telemetry = NULL;
+    _trace = NULL;
+    _bus = 0;
+    memset((void *)_registers, 0x00, sizeof(_registers));
+    _dirty = 0x0000;
+#if SI4703_FEATURE_RDS
+    _rdsHead = _rdsTail = 0;
+    memset((void *)&_rdsStats, 0x00, sizeof(_rdsStats));
+    _rdsStamp = 0;
+    memset((void *)_rdsFilter, 0xFF, sizeof(_rdsFilter));
+    _rdsTolerance = SI4703_RDS_BLER(SI4703_BLER_0, SI4703_BLER_0,
+                                    SI4703_BLER_0, SI4703_BLER_0);
+    _clockUTC = 0;
+#endif
+#if SI4703_FEATURE_INTERRUPTS
+    _slot = SI4703_NO_SLOT;
+    _pending = 0;
+    _pendingStamp = 0;
+    _gpio2High = true;
+    _serviceLatency = 0;
+#endif
+#if SI4703_INSTRUMENTATION
+    _op = SI4703_OP_NONE;
+    resetStats();
+#endif
+}
+
+void Si4703::begin(byte band, bool xosc, byte interrupt) {
+    SI4703_OP(SI4703_OP_BEGIN);
+    startBegin(band, xosc, interrupt);
+
+    //Nothing to do until the chip is up, let others run meanwhile
+    while(!isReady()) {
+        SI4703_COUNT(waitSpins);
+        poll();
+        yield();
+    };
+}
+
+void Si4703::startBegin(byte band, bool xosc, byte interrupt) {
+    SI4703_OP(SI4703_OP_BEGIN);
+    _beginBand = band;
+    _xosc = xosc;
+    //Whatever end() cut short is over, the reset below forgets it too
+    _tuneState = SI4703_TUNE_IDLE;
+#if SI4703_FEATURE_COMMANDS
+    //Reset brings all properties back to their defaults
+    _propertyCount = _propertyNext = 0;
+#endif
+#if SI4703_FEATURE_INTERRUPTS
+    //Calculate if interrupt mode was requested AND is possible: external
+    //interrupts (scarce) always do, pin change interrupts (plenty) only if
+    //someone provided the vectors, see Si4703PCINT.h.
+    _interrupt = (!isPinChange() ||
+                  (_pinChange && digitalPinToPCICR(_pinGPIO2))) ?
+                 interrupt : SI4703_INT_NONE;
+    //Only the main context may switch a shared bus
+    if(_selector && _interrupt == SI4703_INT_DIRECT)
+        _interrupt = SI4703_INT_DEFERRED;
+    _pending = 0;
+#else
+    _interrupt = SI4703_INT_NONE;
+#endif
+
+    //Start by resetting the Si4703 and configuring the communication protocol
+    pinMode(_pinReset, OUTPUT);
+    pinMode(_pinSEN, OUTPUT);
+    //I2C mode, SCLK is always connected to SCL
+    pinMode(SCL, OUTPUT);
+
+    //Put the Si4703 in reset
+    digitalWrite(_pinReset, LOW);
+
+    //Configure for I2C mode; GPIO3 is pulled low by internal pull-down
+    digitalWrite(_pinSEN, HIGH);
+    //SCLK must be high until we start talking to the chip
+    digitalWrite(SCL, HIGH);
+
+    //Use the longest of delays given in the datasheet
+    waitBegin(SI4703_BEGIN_RESET, SI4703_RESET_MICROS);
+}
+
+void Si4703::waitBegin(byte stage, unsigned long wait) {
+    _beginStage = stage;
+    _beginStamp = micros();
+    _beginWait = wait;
+}
+
+void Si4703::advanceBegin(void) {
+    if(micros() - _beginStamp < _beginWait) return;
+
+    switch(_beginStage) {
+        case SI4703_BEGIN_RESET:
+            //Bring the Si4703 out of reset
+            digitalWrite(_pinReset, HIGH);
+
+            //Datasheet calls for 30ns delay; an Arduino running at 20MHz (4MHz
+            //faster than the Uno, mind you) has a clock period of 50ns so no
+            //action needed.
+
+            //Configure GPIO2 for hardware interrupts
+            if(_interrupt) pinMode(_pinGPIO2, INPUT);
+
+            //Configure the I2C hardware
+            Si4703_Transport::begin();
+
+            //Cache the register file before powerup, all of it: commands
+            //write TEST1..BOOTCONFIG back from the shadow, reserved bits
+            //included
+            getRegisterBulk(SI4703_REG_BOOTCONFIG);
+
+            //Enable the crystal oscillator, if present
+            if(_xosc) {
+                setFlags(SI4703_REG_TEST1, SI4703_FLG_XOSCEN);
+                setRegisterBulk();
+                //Wait for the oscillator to stabilize.
+                waitBegin(SI4703_BEGIN_OSCILLATOR, SI4703_XOSC_MICROS);
+                break;
+            };
+            //Fall through
+        case SI4703_BEGIN_OSCILLATOR:
+            //Ask the Si4703 to wake up
+            setFlags(SI4703_REG_POWERCFG,
+                     SI4703_FLG_DMUTE | SI4703_FLG_ENABLE);
+            setRegisterBulk();
+
+            //Wait for it to finish booting
+            waitBegin(SI4703_BEGIN_POWERUP, SI4703_POWERUP_MICROS);
+            break;
+        case SI4703_BEGIN_POWERUP:
+            //Cache the register file after powerup
+            getRegisterBulk(SI4703_REG_SYSCONFIG3);
+
+#if SI4703_FEATURE_INTERRUPTS
+            //Too many of us already, poll instead
+            if(_interrupt && !attachSlot()) _interrupt = SI4703_INT_NONE;
+#endif
+
+            //Configure the Si4703 for operation
+#if SI4703_FEATURE_RDS
+            setFlags(SI4703_REG_POWERCFG, SI4703_FLG_RDSM);
+            setFlags(SI4703_REG_SYSCONFIG1, SI4703_FLG_RDS | SI4703_FLG_DE);
+#else
+            setFlags(SI4703_REG_SYSCONFIG1, SI4703_FLG_DE);
+#endif
+            if(_interrupt)
+                setFlags(SI4703_REG_SYSCONFIG1,
+                         (SI4703_FEATURE_RDS ? SI4703_FLG_RDSIEN : 0) |
+                         SI4703_FLG_STCIEN | SI4703_GPIO2_INT);
+            setFlags(SI4703_REG_SYSCONFIG2,
+                     _beginBand | SI4703_SPACE_100K | SI4703_VOLUME_MASK);
+            setFlags(SI4703_REG_SYSCONFIG3, (1 << SI4703_SKSNR_SHIFT) | 0x1);
+            setRegisterBulk();
+
+#if SI4703_FEATURE_INTERRUPTS
+            //The chip is alive and interrupts have been configured on its
+            //side, switch ourselves to interrupt operation if so requested and
+            //if wiring was properly done.
+            if(_interrupt) hookSlot();
+#endif
+            _beginStage = SI4703_BEGIN_READY;
+            break;
+        case SI4703_BEGIN_RESUME:
+#if SI4703_FEATURE_INTERRUPTS
+            if(_interrupt) hookSlot();
+#endif
+            _beginStage = SI4703_BEGIN_READY;
+
+            //Back where suspend() left it, the channel is already in place
+            setFlags(SI4703_REG_CHANNEL, SI4703_FLG_TUNE);
+            setRegisterBulk();
+            startTune();
+            break;
+    };
+}
+
+const byte Si4703_ChannelSpacings[3] PROGMEM = { 20, 10, 5 };
+
+word Si4703::getFrequency(void) {
+    SI4703_OP(SI4703_OP_STATUS);
+    getRegisterBulk(SI4703_REG_READCHAN);
+
+    return channelFrequency();
+}
+
+bool Si4703::setFrequency(word frequency) {
+    SI4703_OP(SI4703_OP_TUNE);
+    if(!startSetFrequency(frequency)) return false;
+    completeTune();
+
+    return true;
+}
+
+void Si4703::holdTelemetry(bool hold) {
+    if(_telemetry) _telemetry->_held = hold;
+}
+
+bool Si4703::startSetFrequency(word frequency) {
+    SI4703_OP(SI4703_OP_TUNE);
+    const byte band = _registers[SI4703_REG_SYSCONFIG2] & SI4703_BAND_MASK;
+    const byte space = _registers[SI4703_REG_SYSCONFIG2] & SI4703_SPACE_MASK;
+
+    if(!isReady() || _tuneState == SI4703_TUNE_BUSY ||
+       frequency < Si4703_BandBottom(band) || frequency > Si4703_BandTop(band))
+        return false;
+
+    setRegister(SI4703_REG_CHANNEL,
+                (_registers[SI4703_REG_CHANNEL] & ~SI4703_CHAN_MASK) |
+                SI4703_FLG_TUNE |
+                Si4703_FrequencyToChannel(frequency, band, space));
+    setRegisterBulk();
+
+    startTune();
+
+    return true;
+}
+
+void Si4703::setBand(byte band, byte space) {
+    SI4703_OP(SI4703_OP_TUNE);
+    clearFlags(SI4703_REG_SYSCONFIG2, SI4703_BAND_MASK | SI4703_SPACE_MASK);
+    setFlags(SI4703_REG_SYSCONFIG2, band | space);
+    updateRegisters();
+}
+
+void Si4703::seekUp(bool wrap) {
+    SI4703_OP(SI4703_OP_TUNE);
+    startSeek(true, wrap);
+    completeTune();
+}
+
+void Si4703::seekDown(bool wrap) {
+    SI4703_OP(SI4703_OP_TUNE);
+    startSeek(false, wrap);
+    completeTune();
+}
+
+bool Si4703::startSeek(bool up, bool wrap) {
+    SI4703_OP(SI4703_OP_TUNE);
+    if(!isReady() || _tuneState == SI4703_TUNE_BUSY) return false;
+
+    if(wrap)
+        clearFlags(SI4703_REG_POWERCFG, SI4703_FLG_SKMODE);
+    else
+        setFlags(SI4703_REG_POWERCFG, SI4703_FLG_SKMODE);
+    if(up)
+        setFlags(SI4703_REG_POWERCFG, SI4703_FLG_SEEKUP);
+    else
+        clearFlags(SI4703_REG_POWERCFG, SI4703_FLG_SEEKUP);
+    setFlags(SI4703_REG_POWERCFG, SI4703_FLG_SEEK);
+    setRegisterBulk();
+
+    startTune();
+
+    return true;
+}
+
+byte Si4703::poll(void) {
+    SI4703_OP(SI4703_OP_POLL);
+    if(_beginStage != SI4703_BEGIN_READY) {
+        if(_beginStage != SI4703_BEGIN_NONE) advanceBegin();
+
+        return _tuneState;
+    };
+    if(_interrupt == SI4703_INT_DEFERRED) {
+        service();
+
+        return _tuneState;
+    };
+    if(_tuneState != SI4703_TUNE_BUSY) return _tuneState;
+
+    if(!_interrupt) {
+        //Give the chip a rest while it's seeking/tuning, according to
+        //datasheet recommendations.
+        if(micros() - _tuneStamp < SI4703_POLL_INTERVAL * 1000UL)
+            return SI4703_TUNE_BUSY;
+        _tuneStamp = micros();
+        getRegisterBulk(SI4703_REG_STATUSRSSI);
+    };
+
+    if(_registers[SI4703_REG_STATUSRSSI] & SI4703_STATUS_STC) finishTune();
+
+    return _tuneState;
+}
+
+byte Si4703::getRSSI(void) {
+    SI4703_OP(SI4703_OP_STATUS);
+    getRegisterBulk(SI4703_REG_STATUSRSSI);
+
+    return _registers[SI4703_REG_STATUSRSSI] & SI4703_RSSI_MASK;
+}
+
+bool Si4703::volumeUp(void) {
+    SI4703_OP(SI4703_OP_AUDIO);
+    const byte level = getVolume();
+
+    if(level == SI4703_VOLUME_MAX)
+        return false;
+
+    storeVolume(level + 1);
+    updateRegisters();
+
+    return true;
+}
+
+bool Si4703::volumeDown(bool alsomute) {
+    SI4703_OP(SI4703_OP_AUDIO);
+    const byte level = getVolume();
+
+    if(!level)
+        return false;
+
+    storeVolume(level - 1);
+    updateRegisters();
+    if(level == 1 && alsomute)
+        //If we are to trust the datasheet, this is superfluous as a volume
+        //of zero triggers mute on its own.
+        mute();
+    return true;
+}
+
+void Si4703::unMute(bool minvol) {
+    SI4703_OP(SI4703_OP_AUDIO);
+    if(minvol) storeVolume(1);
+    setFlags(SI4703_REG_POWERCFG, SI4703_FLG_DMUTE);
+
+    updateRegisters();
+}
+
+void Si4703::mute(void) {
+    SI4703_OP(SI4703_OP_AUDIO);
+    clearFlags(SI4703_REG_POWERCFG, SI4703_FLG_DMUTE);
+
+    updateRegisters();
+};
+
+bool Si4703::setVolume(byte level) {
+    SI4703_OP(SI4703_OP_AUDIO);
+    if(level > SI4703_VOLUME_MAX) return false;
+
+    storeVolume(level);
+    updateRegisters();
+
+    return true;
+}
+
+byte Si4703::getVolume(void) {
+    //Volume is only ever changed by us, so the shadow is always accurate
+    const byte volume = _registers[SI4703_REG_SYSCONFIG2] & SI4703_VOLUME_MASK;
+
+    if(!SI4703_FEATURE_VOLEXT || !volume ||
+       _registers[SI4703_REG_SYSCONFIG3] & SI4703_FLG_VOLEXT)
+        return volume;
+    else
+        return volume + SI4703_VOLUME_MASK;
+}
+
+void Si4703::storeVolume(byte level) {
+#if SI4703_FEATURE_VOLEXT
+    //Silence is at the bottom of the extended range, like volumeDown() gets
+    //there
+    const bool extended = level <= SI4703_VOLUME_MASK;
+
+    if(extended != !!(_registers[SI4703_REG_SYSCONFIG3] & SI4703_FLG_VOLEXT)) {
+        if(extended)
+            setFlags(SI4703_REG_SYSCONFIG3, SI4703_FLG_VOLEXT);
+        else
+            clearFlags(SI4703_REG_SYSCONFIG3, SI4703_FLG_VOLEXT);
+    };
+    if(!extended) level -= SI4703_VOLUME_MASK;
+#endif
+    if((_registers[SI4703_REG_SYSCONFIG2] & SI4703_VOLUME_MASK) != level)
+        setRegister(SI4703_REG_SYSCONFIG2,
+                    (_registers[SI4703_REG_SYSCONFIG2] & ~SI4703_VOLUME_MASK) |
+                    level);
+}
+
+void Si4703::setMono(bool mono) {
+    SI4703_OP(SI4703_OP_AUDIO);
+    if(mono)
+        setFlags(SI4703_REG_POWERCFG, SI4703_FLG_MONO);
+    else
+        clearFlags(SI4703_REG_POWERCFG, SI4703_FLG_MONO);
+
+    updateRegisters();
+}
+
+void Si4703::setDeemphasis(word deemphasis) {
+    SI4703_OP(SI4703_OP_AUDIO);
+    clearFlags(SI4703_REG_SYSCONFIG1, SI4703_FLG_DE);
+    setFlags(SI4703_REG_SYSCONFIG1, deemphasis & SI4703_FLG_DE);
+
+    updateRegisters();
+}
+
+void Si4703::setSeekThresholds(byte rssi, byte snr, byte count) {
+    SI4703_OP(SI4703_OP_TUNE);
+    setRegister(SI4703_REG_SYSCONFIG2,
+                (_registers[SI4703_REG_SYSCONFIG2] & ~SI4703_SEEKTH_MASK) |
+                (word)rssi << SI4703_SEEKTH_SHIFT);
+    setRegister(SI4703_REG_SYSCONFIG3,
+                (_registers[SI4703_REG_SYSCONFIG3] &
+                 ~(SI4703_SKSNR_MASK | SI4703_SKCNT_MASK)) |
+                (snr << SI4703_SKSNR_SHIFT & SI4703_SKSNR_MASK) |
+                (count & SI4703_SKCNT_MASK));
+
+    updateRegisters();
+}
+
+void Si4703::commitTransaction(void) {
+    _transaction = false;
+
+    setRegisterBulk();
+}
+
+void Si4703::end(void) {
+    SI4703_OP(SI4703_OP_BEGIN);
+    //Whatever is held back goes out below
+    _transaction = false;
+#if SI4703_FEATURE_INTERRUPTS
+    if(_interrupt) detachSlot();
+#endif
+    mute();
+    //A seek or tune under way is abandoned
+    clearFlags(SI4703_REG_CHANNEL, SI4703_FLG_TUNE);
+    clearFlags(SI4703_REG_POWERCFG, SI4703_FLG_SEEK);
+    _tuneState = SI4703_TUNE_IDLE;
+    setFlags(SI4703_REG_POWERCFG, SI4703_FLG_DISABLE);
+    clearFlags(SI4703_REG_SYSCONFIG1, SI4703_FLG_RDS);
+
+    setRegisterBulk();
+    _beginStage = SI4703_BEGIN_NONE;
+#if SI4703_FEATURE_COMMANDS
+    _propertyCount = _propertyNext = 0;
+#endif
+}
+
+void Si4703::suspend(void) {
+    SI4703_OP(SI4703_OP_BEGIN);
+    if(!isReady()) return;
+
+    //Whatever is held back goes out below
+    _transaction = false;
+#if SI4703_FEATURE_INTERRUPTS
+    if(_interrupt) detachSlot();
+#endif
+    //A seek under way has moved the chip on from the last READCHAN we saw
+    if(_registers[SI4703_REG_POWERCFG] & SI4703_FLG_SEEK)
+        getRegisterBulk(SI4703_REG_READCHAN);
+    //resume() tunes to the target of a tune under way, or to where the chip
+    //is otherwise
+    if(!(_registers[SI4703_REG_CHANNEL] & SI4703_FLG_TUNE))
+        setRegister(SI4703_REG_CHANNEL,
+                    (_registers[SI4703_REG_CHANNEL] & ~SI4703_CHAN_MASK) |
+                    (_registers[SI4703_REG_READCHAN] & SI4703_READCHAN_MASK));
+    clearFlags(SI4703_REG_CHANNEL, SI4703_FLG_TUNE);
+    clearFlags(SI4703_REG_POWERCFG, SI4703_FLG_SEEK);
+    _tuneState = SI4703_TUNE_IDLE;
+
+    //Powerdown as per AN230: RDS off, then DISABLE. XOSCEN stays set, and
+    //so does the oscillator.
+    setFlags(SI4703_REG_POWERCFG, SI4703_FLG_DISABLE);
+    clearFlags(SI4703_REG_SYSCONFIG1, SI4703_FLG_RDS);
+    setRegisterBulk();
+    _beginStage = SI4703_BEGIN_SUSPENDED;
+#if SI4703_FEATURE_COMMANDS
+    //Properties live in the chip, not in the register file, and go with
+    //the powerdown
+    _propertyCount = _propertyNext = 0;
+#endif
+}
+
+void Si4703::resume(void) {
+    SI4703_OP(SI4703_OP_BEGIN);
+    if(!startResume()) return;
+
+    //Nothing to do until the chip is up, let others run meanwhile
+    while(!isReady()) {
+        SI4703_COUNT(waitSpins);
+        poll();
+        yield();
+    };
+    completeTune();
+}
+
+bool Si4703::startResume(void) {
+    SI4703_OP(SI4703_OP_BEGIN);
+    if(_beginStage != SI4703_BEGIN_SUSPENDED) return false;
+
+#if SI4703_FEATURE_INTERRUPTS
+    //Someone took our slot meanwhile, poll instead
+    if(_interrupt && !attachSlot()) {
+        _interrupt = SI4703_INT_NONE;
+        clearFlags(SI4703_REG_SYSCONFIG1, SI4703_FLG_RDSIEN |
+                   SI4703_FLG_STCIEN | SI4703_GPIO2_MASK);
+    };
+    _pending = 0;
+#endif
+    //Everything else the chip kept, or gets back from the shadow with the
+    //same write
+    clearFlags(SI4703_REG_POWERCFG, SI4703_FLG_DISABLE);
+#if SI4703_FEATURE_RDS
+    setFlags(SI4703_REG_SYSCONFIG1, SI4703_FLG_RDS);
+#endif
+    setRegisterBulk();
+
+    //Wait for it to finish booting
+    waitBegin(SI4703_BEGIN_RESUME, SI4703_POWERUP_MICROS);
+
+    return true;
+}
+
+#if SI4703_FEATURE_COMMANDS
+bool Si4703::sendCommand(byte command, byte arg0, byte arg1, byte arg2,
+                         byte arg3, byte arg4, byte arg5, byte arg6) {
+    const bool batch = _commandBatch;
+    bool done;
+
+    if(!batch && !beginCommands()) return false;
+
+    //Send the command and its arguments
+    setRegister(SI4703_REG_RDSA, word(arg0, arg1));
+    setRegister(SI4703_REG_RDSB, word(arg2, arg3));
+    setRegister(SI4703_REG_RDSC, word(arg4, arg5));
+    setRegister(SI4703_REG_RDSD, word(arg6, command));
+    setRegisterBulk();
+
+    //Wait for processing
+    done = waitCommand(0x00FF);
+    //Copy the (now valid) response bytes over as re-enabling RDS below may
+    //immediately trigger an interrupt which will clobber our data.
+    memcpy(_response, (void *)&_registers[SI4703_REG_RDSA], sizeof(_response));
+
+    if(!batch) endCommands();
+
+    return done;
+};
+
+bool Si4703::waitCommand(word mask) {
+    const unsigned long stamp = micros();
+
+    do {
+        SI4703_COUNT(commandSpins);
+        getRegisterBulk();
+        if(!(_registers[SI4703_REG_RDSD] & mask)) return true;
+    } while(micros() - stamp < SI4703_COMMAND_MICROS);
+    _commandFailed = true;
+
+    return false;
+}
+
+bool Si4703::beginCommands(void) {
+    SI4703_OP(SI4703_OP_PROPERTY);
+    if(_commandBatch) return true;
+
+    _commandRDS = _registers[SI4703_REG_SYSCONFIG1] & SI4703_FLG_RDS;
+    _commandFailed = false;
+    _commandStamp = micros();
+    _commandBatch = true;
+
+    //Enable command processor
+    clearFlags(SI4703_REG_SYSCONFIG1, SI4703_FLG_RDS);
+    setRegister(SI4703_REG_RDSD, word(0x00, SI4703_CMD_VERIFY_COMMAND));
+    setRegisterBulk();
+    //Wait for activation
+    if(!waitCommand(0xFFFF)) {
+        endCommands();
+        return false;
+    };
+
+    return true;
+}
+
+bool Si4703::endCommands(void) {
+    SI4703_OP(SI4703_OP_PROPERTY);
+    if(!_commandBatch) return false;
+    _commandBatch = false;
+
+    //Restore previous RDS state
+    if(_commandRDS) {
+        setFlags(SI4703_REG_SYSCONFIG1, SI4703_FLG_RDS);
+        setRegisterBulk();
+    };
+    _commandLatency = micros() - _commandStamp;
+
+    return !_commandFailed;
+}
+
+bool Si4703::setProperty(word property, word value) {
+    SI4703_OP(SI4703_OP_PROPERTY);
+    if(!sendCommand(SI4703_CMD_SET_PROPERTY, highByte(value), lowByte(value),
+                    0, 0, highByte(property), lowByte(property)))
+        return false;
+    cacheProperty(property, value);
+
+    return true;
+}
+
+word Si4703::getProperty(word property, bool fresh) {
+    SI4703_OP(SI4703_OP_PROPERTY);
+    const byte index = findProperty(property);
+
+    if(!fresh && index < SI4703_PROPERTY_CACHE_SIZE)
+        return _propertyValues[index];
+    if(!sendCommand(SI4703_CMD_GET_PROPERTY, 0, 0, 0, 0, highByte(property),
+                    lowByte(property)))
+        return 0;
+    //Only what was set is remembered: the chip keeps measurements such as
+    //SI4703_PROP_SNRDB up to date on its own
+    if(index < SI4703_PROPERTY_CACHE_SIZE)
+        _propertyValues[index] = _response[0];
+
+    return _response[0];
+}
+
+byte Si4703::findProperty(word property) {
+    for(byte i = 0; i < _propertyCount; i++)
+        if(_propertyIds[i] == property) return i;
+
+    return SI4703_PROPERTY_CACHE_SIZE;
+}
+
+void Si4703::cacheProperty(word property, word value) {
+    byte index = findProperty(property);
+
+    if(index == SI4703_PROPERTY_CACHE_SIZE) {
+        //Evict the oldest once full
+        index = _propertyNext;
+        _propertyNext = (_propertyNext + 1) % SI4703_PROPERTY_CACHE_SIZE;
+        if(_propertyCount < SI4703_PROPERTY_CACHE_SIZE) _propertyCount++;
+        _propertyIds[index] = property;
+    };
+    _propertyValues[index] = value;
+}
+#endif
+
+#if SI4703_FEATURE_INTERRUPTS
+bool Si4703::service(void) {
+    SI4703_OP(SI4703_OP_INTERRUPT);
+    unsigned long stamp;
+#if SI4703_FEATURE_RDS
+    byte pending;
+#endif
+
+    if(_interrupt != SI4703_INT_DEFERRED || !_pending) return false;
+
+    //Clear it first so that an interrupt coming in while we're busy below is
+    //not lost
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stamp = _pendingStamp;
+#if SI4703_FEATURE_RDS
+        pending = _pending;
+#endif
+        _pending = 0;
+    };
+#if SI4703_FEATURE_RDS
+    const bool tuning = _tuneState == SI4703_TUNE_BUSY;
+#endif
+    refreshAt(stamp);
+#if SI4703_FEATURE_RDS
+    //The registers just read answer for one RDS group and for the seek/tune
+    //that completed, if any; every other interrupt was a group now gone
+    if(_registers[SI4703_REG_STATUSRSSI] & SI4703_STATUS_RDSR) pending--;
+    if(tuning && _registers[SI4703_REG_STATUSRSSI] & SI4703_STATUS_STC &&
+       pending)
+        pending--;
+    if(pending) _rdsStats.dropped += pending;
+#endif
+    _serviceLatency = micros() - stamp;
+
+    return true;
+};
+#else
+bool Si4703::service(void) {
+    //Polling leaves nothing for later
+    return false;
+};
+#endif
+
+void Si4703::refreshAt(unsigned long stamp) {
+    SI4703_OP(SI4703_OP_POLL);
+    getInterruptRegisters();
+#if SI4703_FEATURE_RDS
+    storeRDSGroup(stamp);
+#endif
+
+    if(_tuneState == SI4703_TUNE_BUSY &&
+       _registers[SI4703_REG_STATUSRSSI] & SI4703_STATUS_STC)
+        finishTune();
+};
+
+void Si4703::setBusSelector(Si4703_BusSelector selector, byte bus) {
+    _selector = selector;
+    _bus = bus;
+    //Route again on next use, whoever had it last
+    _busOwner = NULL;
+};
+
+#if SI4703_FEATURE_RDS
+bool Si4703::readRDSGroup(word* block) {
+    unsigned long stamp;
+
+    return readRDSGroup(block, stamp);
+};
+
+bool Si4703::readRDSGroup(word* block, unsigned long &stamp) {
+    byte errors;
+
+    return readRDSGroup(block, stamp, errors);
+};
+
+bool Si4703::readRDSGroup(word* block, unsigned long &stamp, byte &errors) {
+    service();
+
+    const byte tail = _rdsTail;
+
+    if(tail == _rdsHead) return false;
+
+    //The ISR never touches the slot at _rdsTail, so no need to lock it out
+    memcpy(block, (void *)_rdsRing[tail], sizeof(_rdsRing[0]));
+    stamp = _rdsArrivals[tail];
+    errors = _rdsErrors[tail];
+    _rdsTail = (tail + 1) & (SI4703_RDS_RING_SIZE - 1);
+
+    return true;
+};
+
+byte Si4703::readRDSGroups(word block[][4], byte n, unsigned long *stamps) {
+    byte count = 0;
+    unsigned long stamp;
+
+    while(count < n && readRDSGroup(block[count], stamp)) {
+        if(stamps) stamps[count] = stamp;
+        count++;
+    };
+
+    return count;
+};
+
+void Si4703::setRDSFilter(unsigned long groups) {
+    //Kept as bytes, so that the ISR can pick the bit without a long shift
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for(byte i = 0; i < sizeof(_rdsFilter); i++)
+            _rdsFilter[i] = groups >> (8 * i);
+    };
+};
+
+bool Si4703::getClockTime(Si4703_ClockTime &time) {
+    unsigned long utc, received;
+
+    service();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        utc = _clockUTC;
+        received = _clockMillis;
+        time.offset = _clockOffset;
+    };
+    if(!utc) return false;
+
+    time.age = millis() - received;
+    time.utc = utc + time.age / 1000;
+    time.millis = time.age % 1000;
+
+    return true;
+};
+
+void Si4703::getRDSStats(Si4703_RDSStats &stats) {
+    //These on the other hand are multi-byte and updated by the ISR
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        memcpy(&stats, (void *)&_rdsStats, sizeof(stats));
+    };
+};
+#endif
+
+void Si4703::getRegisterBulk(byte last) {
+    const byte count = ((last - SI4703_FIRST_REGISTER_READ) &
+                        SI4703_LAST_REGISTER) + 1;
+    byte buffer[(SI4703_LAST_REGISTER + 1) * 2];
+
+    selectBus();
+
+    const unsigned long stamp = _trace ? micros() : 0;
+    const bool ack = Si4703_Transport::read(SI4703_I2C_ADDR, buffer,
+                                            count * 2);
+
+    SI4703_COUNT_TRANSFER(count * 2);
+    if(_trace) _trace->record(SI4703_TRACE_READ, stamp, ack, buffer, count);
+    //Nothing came back worth keeping, the shadow stays as it was
+    if(!ack) return;
+
+    for(byte i = 0; i < count; i++) {
+        const byte reg = (SI4703_FIRST_REGISTER_READ + i) &
+                         SI4703_LAST_REGISTER;
+
+        //Went over the bus on the way around, but nobody wants them
+        if(reg >= SI4703_SHADOW_SIZE) continue;
+        _registers[reg] = word(buffer[i * 2], buffer[i * 2 + 1]);
+        //The shadow now matches the chip
+        _dirty &= ~bit(reg);
+    };
+    if(_telemetry) _telemetry->sample(last != SI4703_REG_STATUSRSSI);
+};
+
+void Si4703::setRegisterBulk(void) {
+    byte count = 0;
+
+    //Writes always start at POWERCFG, so the shortest write is the one that
+    //ends with the last dirty register.
+    for(byte reg = SI4703_FIRST_REGISTER_WRITE; reg < SI4703_SHADOW_SIZE;
+        reg++)
+        if(_dirty & bit(reg)) count = reg - SI4703_FIRST_REGISTER_WRITE + 1;
+
+    //Account against what we used to write unconditionally: the writable
+    //registers, TEST1 when needed or everything up to RDSD for commands.
+    _writeBytesSaved += 2 * ((count > 6 ? 14 : max(count, (byte)5)) - count);
+
+    if(!count) return;
+
+    byte buffer[(SI4703_LAST_REGISTER + 1) * 2];
+
+    for(byte i = 0; i < count; i++) {
+        buffer[i * 2] = highByte(_registers[SI4703_FIRST_REGISTER_WRITE + i]);
+        buffer[i * 2 + 1] = lowByte(
+            _registers[SI4703_FIRST_REGISTER_WRITE + i]);
+    };
+
+    selectBus();
+
+    const unsigned long stamp = _trace ? micros() : 0;
+    const bool ack = Si4703_Transport::write(SI4703_I2C_ADDR, buffer,
+                                             count * 2);
+
+    SI4703_COUNT_TRANSFER(count * 2);
+    if(_trace) _trace->record(SI4703_TRACE_WRITE, stamp, ack, buffer, count);
+    //Still to be written, next time round
+    if(ack) _dirty = 0x0000;
+};
+
+void Si4703::selectBus(void) {
+    if(!_selector || _busOwner == this) return;
+
+    _selector(_bus);
+    _busOwner = this;
+}
+
+#if SI4703_INSTRUMENTATION
+void Si4703::getStats(Si4703_Stats &stats) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        memcpy(&stats, (void *)&_stats, sizeof(stats));
+    };
+}
+
+void Si4703::resetStats(void) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        memset((void *)&_stats, 0x00, sizeof(_stats));
+    };
+}
+
+void Si4703::countTransfer(byte count) {
+    const byte op = _op == SI4703_OP_NONE ? SI4703_OP_OTHER : _op;
+
+    _stats.transactions[op]++;
+    _stats.bytes[op] += count + 1;
+}
+
+/*
+* Description:
+*   Finds the histogram bucket for duration, bucket 0 ending at first.
+*/
+static byte histogramBucket(unsigned long duration, unsigned long first) {
+    byte bucket = 0;
+
+    while(bucket < SI4703_HISTOGRAM_BUCKETS - 1 && duration >= first << bucket)
+        bucket++;
+
+    return bucket;
+}
+
+void Si4703::countInterrupt(unsigned long duration) {
+    _stats.interrupts++;
+    _stats.interruptMicros += duration;
+    if(duration > _stats.interruptMax) _stats.interruptMax = duration;
+    _stats.interruptHistogram[histogramBucket(
+        duration, SI4703_HISTOGRAM_INTERRUPT_MICROS)]++;
+}
+
+void Si4703::countTune(unsigned long duration) {
+    _stats.tunes++;
+    _stats.tuneMicros += duration;
+    if(duration > _stats.tuneMax) _stats.tuneMax = duration;
+    _stats.tuneHistogram[histogramBucket(
+        duration, SI4703_HISTOGRAM_TUNE_MICROS)]++;
+}
+#endif
+
+word Si4703::channelFrequency(void) {
+    return Si4703_ChannelToFrequency(
+        _registers[SI4703_REG_READCHAN] & SI4703_READCHAN_MASK,
+        _registers[SI4703_REG_SYSCONFIG2] & SI4703_BAND_MASK,
+        _registers[SI4703_REG_SYSCONFIG2] & SI4703_SPACE_MASK);
+}
+
+void Si4703::startTune(void) {
+    //Whatever STC we saw last belongs to the previous operation
+    _registers[SI4703_REG_STATUSRSSI] &= ~SI4703_STATUS_STC;
+    _tuneState = SI4703_TUNE_BUSY;
+    _tuneStamp = micros();
+#if SI4703_INSTRUMENTATION
+    _tuneStart = _tuneStamp;
+#endif
+}
+
+void Si4703::completeTune(void) {
+    //Nothing to do until the chip is done, let others run meanwhile
+    while(poll() == SI4703_TUNE_BUSY) {
+        SI4703_COUNT(waitSpins);
+        yield();
+    };
+}
+
+void Si4703::finishTune(void) {
+#if SI4703_FEATURE_RDS
+    //Groups still in the ring belong to the previous station
+    _rdsTail = _rdsHead;
+#endif
+
+    //Find out where we ended up, unless the ISR already brought READCHAN in
+    //along with the RDS registers
+    if(!_interrupt || !(_registers[SI4703_REG_SYSCONFIG1] & SI4703_FLG_RDS))
+        getRegisterBulk(SI4703_REG_READCHAN);
+    _tuneState = _registers[SI4703_REG_STATUSRSSI] & SI4703_STATUS_SFBL ?
+                 SI4703_TUNE_FAILED : SI4703_TUNE_COMPLETE;
+    _tuneFrequency = channelFrequency();
+#if SI4703_INSTRUMENTATION
+    countTune(micros() - _tuneStart);
+#endif
+
+    //Reset STC and SF/BL flags by ending whichever operation it was
+    if(_registers[SI4703_REG_CHANNEL] & SI4703_FLG_TUNE)
+        clearFlags(SI4703_REG_CHANNEL, SI4703_FLG_TUNE);
+    else
+        clearFlags(SI4703_REG_POWERCFG, SI4703_FLG_SEEK);
+    setRegisterBulk();
+
+    if(_tuneCallback)
+        _tuneCallback(_tuneFrequency, _tuneState == SI4703_TUNE_FAILED);
+}
+
+void Si4703::getInterruptRegisters(void) {
+    //Only fetch the RDS registers if the interrupt could have come from there
+    getRegisterBulk(
+        _registers[SI4703_REG_SYSCONFIG1] & SI4703_FLG_RDS ?
+        SI4703_REG_RDSD : SI4703_REG_STATUSRSSI);
+}
+
+#if SI4703_FEATURE_INTERRUPTS
+bool Si4703::attachSlot(void) {
+    byte slot;
+
+    //Our own slot first: taking a free one in front of it would leave us in
+    //two, and the other one dispatching to us forever
+    for(slot = 0; slot < SI4703_MAX_INSTANCES; slot++)
+        if(_instances[slot] == this) break;
+    if(slot == SI4703_MAX_INSTANCES)
+        for(slot = 0; slot < SI4703_MAX_INSTANCES; slot++)
+            if(!_instances[slot]) break;
+    if(slot == SI4703_MAX_INSTANCES) return false;
+
+    _instances[slot] = this;
+    _slot = slot;
+
+    return true;
+}
+
+void Si4703::detachSlot(void) {
+    if(_slot == SI4703_NO_SLOT) return;
+
+    if(isPinChange()) {
+        volatile uint8_t * const pcmsk = digitalPinToPCMSK(_pinGPIO2);
+
+        *pcmsk &= ~bit(digitalPinToPCMSKbit(_pinGPIO2));
+        //Leave the bank enabled for whoever else is still in it
+        if(!*pcmsk)
+            *digitalPinToPCICR(_pinGPIO2) &=
+                ~bit(digitalPinToPCICRbit(_pinGPIO2));
+    } else
+        detachInterrupt(digitalPinToInterrupt(_pinGPIO2));
+    _instances[_slot] = NULL;
+    _slot = SI4703_NO_SLOT;
+}
+
+void Si4703::hookSlot(void) {
+    if(isPinChange()) {
+        _gpio2High = digitalRead(_pinGPIO2);
+        *digitalPinToPCMSK(_pinGPIO2) |= bit(digitalPinToPCMSKbit(_pinGPIO2));
+        *digitalPinToPCICR(_pinGPIO2) |= bit(digitalPinToPCICRbit(_pinGPIO2));
+    } else
+        attachInterrupt(digitalPinToInterrupt(_pinGPIO2),
+                        _trampolines[_slot], FALLING);
+    interrupts();
+}
+
+bool Si4703::isPinChange(void) {
+    return digitalPinToInterrupt(_pinGPIO2) == NOT_AN_INTERRUPT;
+}
+
+void Si4703::interruptServiceRoutine(void) {
+    //When the chip signalled, for the RDS group stamps
+    const unsigned long stamp = micros();
+#if SI4703_INSTRUMENTATION
+    Si4703_OpScope scope(_op, SI4703_OP_INTERRUPT, true);
+#endif
+
+    if(_trace)
+        _trace->record(SI4703_TRACE_INTERRUPT, stamp, true, NULL, 0);
+    if(_interrupt == SI4703_INT_DEFERRED) {
+        //service() tells what they were about once it reads the registers
+        if(_pending < 0xFF) _pending++;
+        _pendingStamp = stamp;
+    } else {
+        NONATOMIC_BLOCK(NONATOMIC_RESTORESTATE) {
+            //Most unfortunately, Wire (the default transport) is interrupt
+            //based.
+            getInterruptRegisters();
+        };
+
+#if SI4703_FEATURE_RDS
+        storeRDSGroup(stamp);
+#endif
+    };
+#if SI4703_INSTRUMENTATION
+    countInterrupt(micros() - stamp);
+#endif
+}
+
+void Si4703::dispatchPinChange(byte bank) {
+    for(byte slot = 0; slot < SI4703_MAX_INSTANCES; slot++) {
+        Si4703 * const radio = _instances[slot];
+
+        //Not ours, or not hooked up yet (slots are taken before that)
+        if(!radio || !radio->isPinChange() ||
+           digitalPinToPCICRbit(radio->_pinGPIO2) != bank ||
+           !(*digitalPinToPCMSK(radio->_pinGPIO2) &
+             bit(digitalPinToPCMSKbit(radio->_pinGPIO2))))
+            continue;
+
+        const bool high = digitalRead(radio->_pinGPIO2);
+        const bool falling = radio->_gpio2High && !high;
+
+        //Any pin in the bank may have fired this, and so may the rising edge
+        //at the end of the Si4703's 5ms pulse; record the level first as the
+        //direct mode handler lets other interrupts in.
+        radio->_gpio2High = high;
+        if(falling) radio->interruptServiceRoutine();
+    };
+}
+
+void Si4703::dispatchInterrupt0(void) {
+    _instances[0]->interruptServiceRoutine();
+}
+
+#if SI4703_MAX_INSTANCES > 1
+void Si4703::dispatchInterrupt1(void) {
+    _instances[1]->interruptServiceRoutine();
+}
+#endif
+
+#if SI4703_MAX_INSTANCES > 2
+void Si4703::dispatchInterrupt2(void) {
+    _instances[2]->interruptServiceRoutine();
+}
+#endif
+
+#if SI4703_MAX_INSTANCES > 3
+void Si4703::dispatchInterrupt3(void) {
+    _instances[3]->interruptServiceRoutine();
+}
+#endif
+#endif
+
+#if SI4703_FEATURE_RDS
+void Si4703::storeRDSGroup(unsigned long stamp) {
+    //RDSR stays up for a while and groups are a lot further apart than that,
+    //so one seen this soon after the last is the same group again (this
+    //happens when polling or on an STC interrupt).
+    if(_registers[SI4703_REG_STATUSRSSI] & SI4703_STATUS_RDSR &&
+       micros() - _rdsStamp >= SI4703_RDSR_MICROS) {
+        _rdsStamp = micros();
+        //A future call to getRegisterBulk() may clobber the RDS group the chip
+        //is trying to give us righ now, so copy this one over if it's good
+        //enough to save.
+        //BLERA..BLERD, packed as SI4703_RDS_BLER() does
+        const byte errors =
+            (_registers[SI4703_REG_STATUSRSSI] & SI4703_BLERA_MASK) >> 3 |
+            (_registers[SI4703_REG_READCHAN] & (SI4703_BLERB_MASK |
+                                                SI4703_BLERC_MASK |
+                                                SI4703_BLERD_MASK)) >> 10;
+        const word blockB = _registers[SI4703_REG_RDSB];
+        const byte type = blockB >> SI4703_RDS_GROUP_SHIFT;
+        bool good = true;
+
+        //Error free groups are the rule, skip the per block comparisons
+        if(errors)
+            for(byte shift = 0; shift < 8; shift += 2)
+                if((errors >> shift & 0x03) > (_rdsTolerance >> shift & 0x03))
+                    good = false;
+        if(!good)
+            _rdsStats.rejected++;
+        else {
+            const byte head = _rdsHead;
+            const byte next = (head + 1) & (SI4703_RDS_RING_SIZE - 1);
+
+            //The clock is kept apart from the ring, so that it is set now
+            //and even if the ring is full or filtered. Corrected bits are
+            //good enough to pass a group on, not to set the clock by:
+            //that takes B, C and D without errors whatever the tolerance
+            if((blockB & SI4703_RDS_GROUP_MASK) == SI4703_RDS_GROUP_4A &&
+               !(errors & 0x3F))
+                storeClockTime(stamp);
+            if(!(_rdsFilter[type >> 3] & 1 << (type & 0x07)))
+                _rdsStats.filtered++;
+            //Keep what the application has not read yet, lose the newest
+            else if(next == _rdsTail)
+                _rdsStats.dropped++;
+            else {
+                memcpy((void *)_rdsRing[head],
+                       (void *)&_registers[SI4703_REG_RDSA],
+                       sizeof(_rdsRing[0]));
+                _rdsArrivals[head] = stamp;
+                _rdsErrors[head] = errors;
+                //Only publish the slot once it's been filled in
+                _rdsHead = next;
+                _rdsStats.accepted++;
+            };
+        };
+    };
+}
+
+void Si4703::storeClockTime(unsigned long stamp) {
+    const word blockB = _registers[SI4703_REG_RDSB];
+    const word blockC = _registers[SI4703_REG_RDSC];
+    const word blockD = _registers[SI4703_REG_RDSD];
+    const unsigned long mjd = (unsigned long)(blockB & 0x0003) << 15 |
+                              blockC >> 1;
+    const byte hour = (blockC & 0x0001) << 4 | blockD >> 12;
+    const byte minute = (blockD >> 6) & 0x3F;
+
+    //Stations without a clock send all zeroes
+    if(mjd <= SI4703_MJD_UNIX || hour > 23 || minute > 59) return;
+
+    _clockUTC = (mjd - SI4703_MJD_UNIX) * 86400UL + hour * 3600UL +
+                minute * 60U;
+    _clockOffset = blockD & 0x0020 ? -(blockD & 0x001F) : blockD & 0x001F;
+    //micros() wraps around after 71 minutes, millis() lasts longer
+    _clockMillis = millis() - (micros() - stamp) / 1000;
+}
+#endif
+
+#if SI4703_FEATURE_INTERRUPTS
+Si4703 *Si4703::_instances[] = {NULL};
+void (* const Si4703::_trampolines[])(void) = {
+    Si4703::dispatchInterrupt0,
+#if SI4703_MAX_INSTANCES > 1
+    Si4703::dispatchInterrupt1,
+#endif
+#if SI4703_MAX_INSTANCES > 2
+    Si4703::dispatchInterrupt2,
+#endif
+#if SI4703_MAX_INSTANCES > 3
+    Si4703::dispatchInterrupt3,
+#endif
+};
+bool Si4703::_pinChange = false;
+#endif
+Si4703 *Si4703::_busOwner = NULL;
+
+#if SI4703_TRANSPORT_ID(SI4703_TRANSPORT) == \
+    SI4703_TRANSPORT_Si4703_BitBangTransport
+volatile uint8_t *Si4703_BitBangTransport::_sdaDDR;
+volatile uint8_t *Si4703_BitBangTransport::_sdaPIN;
+volatile uint8_t *Si4703_BitBangTransport::_sclDDR;
+volatile uint8_t *Si4703_BitBangTransport::_sclPIN;
+uint8_t Si4703_BitBangTransport::_sdaMask;
+uint8_t Si4703_BitBangTransport::_sclMask;
+#elif SI4703_TRANSPORT_ID(SI4703_TRANSPORT) == \
+      SI4703_TRANSPORT_Si4703_LinuxTransport
+int Si4703_LinuxTransport::_fd = -1;
+#endif
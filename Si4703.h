@@ -1,394 +1,1215 @@
-/* Arduino Si4703 (and family) Library
- * See the README file for author and licensing information. In case it's
- * missing from your distribution, use the one here as the authoritative
- * version: https://github.com/csdexter/Si4703/blob/master/README
- *
- * This library is for use with the SparkFun Si4703 Evaluation or Breakout
- * Boards.
- * See the example sketches to learn how to use the library in your code.
- *
- * This is the main include file for the library.
- */
-
-#ifndef _SI4703_H_INCLUDED
-#define _SI4703_H_INCLUDED
-
-#if defined(ARDUINO) && ARDUINO >= 100
-# include <Arduino.h>
-#else
-# include <WProgram.h>
-#endif
-
-//Assign the pin numbers (evaluation or breakout board version)
-//SDIO and SCLK always connected to SDA and SCL
-#define SI4703_PIN_SEN SS
-#define SI4703_PIN_RESET 9
-#define SI4703_PIN_GPIO2 2
-
-//Constants for hardwired pins
-//Chip interfaced via I2C, SEN tied high in hardware
-//Define both HW and HWH constants to suit both semantics when typing
-#define SI4703_PIN_SEN_HW 0xFF
-#define SI4703_PIN_SEN_HWH 0xFF
-//GPIO2/#INT not used, pin left floating
-#define SI4703_PIN_GPIO2_HW 0xFF
-
-//Register file origins for sequential mode
-#define SI4703_FIRST_REGISTER_WRITE 0x02
-#define SI4703_FIRST_REGISTER_READ 0x0A
-#define SI4703_LAST_REGISTER 0x0F
-
-//Si4703 register addresses
-#define SI4703_REG_DEVICEID 0x00
-#define SI4703_REG_CHIPID 0x01
-#define SI4703_REG_POWERCFG 0x02
-#define SI4703_REG_CHANNEL 0x03
-#define SI4703_REG_SYSCONFIG1 0x04
-#define SI4703_REG_SYSCONFIG2 0x05
-#define SI4703_REG_SYSCONFIG3 0x06
-#define SI4703_REG_TEST1 0x07
-#define SI4703_REG_TEST2 0x08
-#define SI4703_REG_BOOTCONFIG 0x09
-#define SI4703_REG_STATUSRSSI 0x0A
-#define SI4703_REG_READCHAN 0x0B
-#define SI4703_REG_RDSA 0x0C
-#define SI4703_REG_RDSB 0x0D
-#define SI4703_REG_RDSC 0x0E
-#define SI4703_REG_RDSD 0x0F
-
-//Status bits (from the chip)
-#define SI4703_STATUS_RDSR 0x8000
-#define SI4703_STATUS_STC 0x4000
-#define SI4703_STATUS_SFBL 0x2000
-#define SI4703_STATUS_AFCRL 0x1000
-#define SI4703_STATUS_RDSS 0x0800
-#define SI4703_STATUS_ST 0x0100
-
-//Flag bits (to the chip)
-#define SI4703_FLG_DSMUTE 0x8000
-#define SI4703_FLG_DMUTE 0x4000
-#define SI4703_FLG_MONO 0x2000
-#define SI4703_FLG_RDSM 0x0800
-#define SI4703_FLG_SKMODE 0x0400
-#define SI4703_FLG_SEEKUP 0x0200
-#define SI4703_FLG_SEEK 0x0100
-#define SI4703_FLG_DISABLE word(0x0040)
-#define SI4703_FLG_ENABLE word(0x0001)
-#define SI4703_FLG_TUNE 0x8000
-#define SI4703_FLG_RDSIEN 0x8000
-#define SI4703_FLG_STCIEN 0x4000
-#define SI4703_FLG_RDS 0x1000
-#define SI4703_FLG_DE 0x0800
-#define SI4703_FLG_AGCD 0x0400
-#define SI4703_FLG_VOLEXT 0x0100
-#define SI4703_FLG_XOSCEN 0x8000
-#define SI4703_FLG_AHIZEN 0x4000
-
-//Masks and constants for configuration parameters
-#define SI4703_PN_MASK 0xF000
-#define SI4703_PN_SI4700_1 (0x0 << 12)
-#define SI4703_PN_SI4702_3 (0x1 << 12)
-#define SI4703_MFGID_MASK 0x0FFF
-#define SI4703_MFGID_SILABS 0x0242
-#define SI4703_REV_MASK 0xFC00
-#define SI4703_REV_C (0x04 << 10)
-#define SI4703_DEV_MASK 0x03C0
-#define SI4703_DEV_SI4702_OFF (0x0 << 6)
-#define SI4703_DEV_SI4702_ON (0x1 << 6)
-#define SI4703_DEV_SI4703_OFF (0x8 << 6)
-#define SI4703_DEV_SI4703_ON (0x9 << 6)
-#define SI4703_FIRMWARE_MASK word(0x003F)
-#define SI4703_FIRMWARE_OFF 0x00
-#define SI4703_FIRMWARE_ON 0x13
-#define SI4703_CHAN_MASK 0x03FF
-#define SI4703_BLNDADJ_MASK word(0x00C0)
-#define SI4703_BLNDADJ_31_49DB (0x0 << 6)
-#define SI4703_BLNDADJ_37_55DB (0x1 << 6)
-#define SI4703_BLNDADJ_19_37DB (0x2 << 6)
-#define SI4703_BLNDADJ_25_43DB (0x3 << 6)
-#define SI4703_GPIO3_MASK word(0x0030)
-#define SI4703_GPIO3_HIZ (0x0 << 4)
-#define SI4703_GPIO3_ST (0x1 << 4)
-#define SI4703_GPIO3_L (0x2 << 4)
-#define SI4703_GPIO3_H (0x3 << 4)
-#define SI4703_GPIO2_MASK word(0x000C)
-#define SI4703_GPIO2_HIZ (0x0 << 2)
-#define SI4703_GPIO2_INT (0x1 << 2)
-#define SI4703_GPIO2_L (0x2 << 2)
-#define SI4703_GPIO2_H (0x3 << 2)
-#define SI4703_GPIO1_MASK word(0x0003)
-#define SI4703_GPIO1_HIZ 0x0
-#define SI4703_GPIO1_L 0x2
-#define SI4703_GPIO1_H 0x3
-#define SI4703_SEEKTH_MASK 0xFF00
-#define SI4703_SEEKTH_SHIFT 8
-#define SI4703_BAND_MASK word(0x00C0)
-#define SI4703_BAND_WEST (0x0 << 6)
-#define SI4703_BAND_WORLD (0x1 << 6)
-#define SI4703_BAND_EAST (0x2 << 6)
-#define SI4703_SPACE_MASK word(0x0030)
-#define SI4703_SPACE_200K (0x0 << 4)
-#define SI4703_SPACE_100K (0x1 << 4)
-#define SI4703_SPACE_50K (0x2 << 4)
-#define SI4703_VOLUME_MASK word(0x000F)
-#define SI4703_SMUTER_MASK 0xC000
-#define SI4703_SMUTER_FASTEST (0x0 << 14)
-#define SI4703_SMUTER_FAST (0x1 << 14)
-#define SI4703_SMUTER_SLOW (0x2 << 14)
-#define SI4703_SMUTER_SLOWEST (0x3 << 14)
-#define SI4703_SMUTEA_MASK 0x3000
-#define SI4703_SMUTEA_16DB (0x0 << 12)
-#define SI4703_SMUTEA_14DB (0x1 << 12)
-#define SI4703_SMUTEA_12DB (0x2 << 12)
-#define SI4703_SMUTEA_10DB (0x3 << 12)
-#define SI4703_SKSNR_MASK word(0x00F0)
-#define SI4703_SKSNR_SHIFT 4
-#define SI4703_SKCNT_MASK word(0x000F)
-#define SI4703_BLERA_MASK 0x0600
-#define SI4703_BLERA_0 (0x0 << 9)
-#define SI4703_BLERA_12 (0x1 << 9)
-#define SI4703_BLERA_35 (0x2 << 9)
-#define SI4703_BLERA_U (0x3 << 9)
-#define SI4703_RSSI_MASK word(0x00FF)
-#define SI4703_BLERB_MASK 0xC000
-#define SI4703_BLERB_0 (0x0 << 14)
-#define SI4703_BLERB_12 (0x1 << 14)
-#define SI4703_BLERB_35 (0x2 << 14)
-#define SI4703_BLERB_U (0x3 << 14)
-#define SI4703_BLERC_MASK 0x3000
-#define SI4703_BLERC_0 (0x0 << 12)
-#define SI4703_BLERC_12 (0x1 << 12)
-#define SI4703_BLERC_35 (0x2 << 12)
-#define SI4703_BLERC_U (0x3 << 12)
-#define SI4703_BLERD_MASK 0x0C00
-#define SI4703_BLERD_0 (0x0 << 10)
-#define SI4703_BLERD_12 (0x1 << 10)
-#define SI4703_BLERD_35 (0x2 << 10)
-#define SI4703_BLERD_U (0x3 << 10)
-#define SI4703_READCHAN_MASK 0x03FF
-
-//Commands
-#define SI4703_CMD_SET_PROPERTY 0x07
-#define SI4703_CMD_GET_PROPERTY 0x08
-#define SI4703_CMD_VERIFY_COMMAND 0xFF
-
-//Properties
-#define SI4703_PROP_FM_DETECTOR_SNR 0x0200
-#define SI4703_PROP_BLEND_MONO_RSSI 0x0300
-#define SI4703_PROP_BLEND_STEREO_RSSI 0x0301
-#define SI4703_PROP_CALCODE 0x0700
-#define SI4703_PROP_SNRDB 0x0C00
-
-extern const byte Si4703_ChannelSpacings[];
-
-class Si4703
-{
-    public:
-        /*
-        * Description:
-        *   This the constructor. It assumes SparkFun Si4703 Evaluation or
-        *   Breakout Board + level shifter (or 3.3V-native Arduino) semantics
-        *   if called without parameters.
-        *   If you're not using the SparkFun Evaluation or Breakout Boards or
-        *   have wired the Si4703 differently, then explicitly supply the
-        *   constructor with the actual pin numbers.
-        *   Use the hardwired pins constants above to tell the constructor you
-        *   haven't used (and hardwired) some of the pins.
-        * Parameters:
-        *   pin*      - pin numbers for connections to the Si4703, with
-        *               defaults for the SparkFun Evaluation or Breakout 
-        *               Boards already provided.
-        */
-        Si4703(byte pinReset = SI4703_PIN_RESET,
-               byte pinGPIO2 = SI4703_PIN_GPIO2, byte pinSEN = SI4703_PIN_SEN);
-
-        /*
-        * Description:
-        *   This is the destructor, it delegates to end().
-        */
-        ~Si4703() { end(); };
-
-        /*
-        * Description:
-        *   Initializes the Si4703 and powers up the radio with the desired
-        *   band limits.
-        *   This function must be called before any other radio command.
-        * Parameters:
-        *   band        - the desired FM band, one of the SI4703_BAND_*
-        *                 constants.
-        *   xosc        - a 32768Hz external oscillator is present.
-        *   interrupt   - interrupt mode is to be used (as opposed to polling)
-        *                 when waiting for the chip to perform an operation.
-        */
-        void begin(byte band, bool xosc = true, bool interrupt = true);
-
-        /*
-        * Description:
-        *   Gets the frequency the chip is currently tuned to.
-        * Returns:
-        *   frequency in 10kHz units.
-        */
-        word getFrequency(void);
-
-        /*
-        * Description:
-        *   Commands the radio to seek up to the next valid channel.
-        * Parameters:
-        *   wrap - set to true to allow the seek to wrap around the current
-        *          band.
-        */
-        void seekUp(bool wrap = true);
-
-        /*
-        * Description:
-        *   Commands the radio to seek down to the next valid channel.
-        * Parameters:
-        *   wrap - set to true to allow the seek to wrap around the current
-        *          band.
-        */
-        void seekDown(bool wrap = true);
-
-        /*
-        * Description:
-        *   Retrieves the Received Signal Strength Indication measurement for
-        *   the currently tuned station.
-        */
-        byte getRSSI(void);
-
-        /*
-        * Description:
-        *   Increase the volume by 1. If the maximum volume has been
-        *   reached, no further increase will take place and returns false;
-        *   otherwise true.
-        */
-        bool volumeUp(void);
-
-        /*
-        * Description:
-        *   Decrease the volume by 1. If the minimum volume has been
-        *   reached, no further decrease will take place and returns false;
-        *   otherwise true.
-        * Parameters:
-        *   alsomute - mute the output when reaching minimum volume, in
-        *               addition to returning false
-        */
-        bool volumeDown(bool alsomute = false);
-
-        /*
-        * Description:
-        *   Mutes the audio output.
-        */
-        void mute(void);
-
-        /*
-        * Description:
-        *   Unmutes the audio output.
-        * Parameters:
-        *   minvol - set the volume to minimum value before unmuting if true,
-        *            otherwise leave it untouched causing the chip to blast
-        *            audio out at whatever the previous volume level was.
-        */
-        void unMute(bool minvol = false);
-
-        /*
-        * Description:
-        *   Mutes and disables the chip.
-        */
-        void end(void);
-
-        /*
-        * Description:
-        *   Sets a property value, see the SI4703_PROP_* constants and the
-        *   Si4703 Datasheet for more information.
-        */
-        void setProperty(word property, word value);
-
-        /*
-        * Description:
-        *   Gets a property value, see the SI4703_PROP_* constants and the
-        *   Si4703 Datasheet for more information.
-        * Returns:
-        *   The current value of property.
-        */
-        word getProperty(word property);
-
-        /*
-        * Description:
-        *   Accessor for the status register.
-        */
-        word getStatus(void) { return _registers[SI4703_REG_STATUSRSSI]; };
-
-        /*
-        * Description:
-        *   If the chip has received any valid RDS group, fetch it off the chip
-        *   and fill word block[4] with it, returning true; otherwise return
-        *   false without side-effects.
-        *   As RDS has a [mandated by standard] constant transmission rate of
-        *   11.4 groups per second, you should actively call this function (e.g.
-        *   from loop()) so that you read most if not all of the error-corrected
-        *   RDS groups received. For example:
-        *   loop() {
-        *     if(Si4703::readRDSGroup(data))
-        *       RDSDecoder::decodeRDSGroup(data);
-        *   }
-        */
-        bool readRDSGroup(word* block);
-
-    private:
-        byte _pinReset, _pinGPIO2, _pinSEN;
-        bool _interrupt;
-        static volatile word _registers[SI4703_LAST_REGISTER];
-        word _response[4];
-        static volatile word _rdsBlocks[4];
-        static volatile bool _haveRds;
-
-        /*
-        * Description:
-        *   Used to send a command and its arguments to the radio chip.
-        * Parameters:
-        *   command - the command byte, see datasheet and use one of the
-        *             SI4703_CMD_* constants
-        *   arg1-7  - command arguments, see the Si4703 Programmers Guide.
-        */
-        void sendCommand(byte command, byte arg0 = 0, byte arg1 = 0,
-                         byte arg2 = 0, byte arg3 = 0, byte arg4 = 0,
-                         byte arg5 = 0, byte arg6 = 0);
-
-        /*
-        * Description:
-        *   Update the register file in bulk as the Si4703 doesn't support
-        *   random access to its registers via I2C.
-        * Parameters:
-        *   all  - read the entire register file, as opposed to just the
-        *          readable registers (0xA->0xF)
-        *   test - include register TEST1 (0x7) in the write operation,
-        *          otherwise stop at the writable registers (0x2->0x6)
-        *   cmd  - a command is to be sent via the RDS registers, write the
-        *          entire register file up to 0xF
-        */
-        static void getRegisterBulk(bool all = false);
-        void setRegisterBulk(bool test = false, bool cmd = false);
-
-        /*
-        * Description:
-        *   Waits for completion of various operations.
-        * Parameters:
-        *   which - interrupt flag to wait for, see SI4703_STATUS_*
-        */
-        void waitForInterrupt(word which);
-
-        /*
-        * Description:
-        *   Performs actions common to all tuning modes.
-        */
-        void completeTune(void);
-
-        /*
-        * Description:
-        *
-        * Services interrupts from the Si4703.
-        */
-        static void interruptServiceRoutine(void);
-};
-
-#endif
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the main include file for the library.
+ */
+
+#ifndef _SI4703_H_INCLUDED
+#define _SI4703_H_INCLUDED
+
+#if defined(ARDUINO) && ARDUINO >= 100
+# include <Arduino.h>
+#else
+# include <WProgram.h>
+#endif
+
+#include "Si4703-config.h"
+
+//Assign the pin numbers (evaluation or breakout board version)
+//SDIO and SCLK always connected to SDA and SCL
+#define SI4703_PIN_SEN SS
+#define SI4703_PIN_RESET 9
+#define SI4703_PIN_GPIO2 2
+
+//Constants for hardwired pins
+//Chip interfaced via I2C, SEN tied high in hardware
+//Define both HW and HWH constants to suit both semantics when typing
+#define SI4703_PIN_SEN_HW 0xFF
+#define SI4703_PIN_SEN_HWH 0xFF
+//GPIO2/#INT not used, pin left floating
+#define SI4703_PIN_GPIO2_HW 0xFF
+
+//Register file origins for sequential mode
+#define SI4703_FIRST_REGISTER_WRITE 0x02
+#define SI4703_FIRST_REGISTER_READ 0x0A
+#define SI4703_LAST_REGISTER 0x0F
+//Registers kept in the shadow: RDSA..RDSD still go over the bus when reads
+//wrap around, but only RDS and the command processor look at them
+#if SI4703_FEATURE_RDS || SI4703_FEATURE_COMMANDS
+# define SI4703_SHADOW_SIZE (SI4703_LAST_REGISTER + 1)
+#else
+# define SI4703_SHADOW_SIZE SI4703_REG_RDSA
+#endif
+
+//Si4703 register addresses
+#define SI4703_REG_DEVICEID 0x00
+#define SI4703_REG_CHIPID 0x01
+#define SI4703_REG_POWERCFG 0x02
+#define SI4703_REG_CHANNEL 0x03
+#define SI4703_REG_SYSCONFIG1 0x04
+#define SI4703_REG_SYSCONFIG2 0x05
+#define SI4703_REG_SYSCONFIG3 0x06
+#define SI4703_REG_TEST1 0x07
+#define SI4703_REG_TEST2 0x08
+#define SI4703_REG_BOOTCONFIG 0x09
+#define SI4703_REG_STATUSRSSI 0x0A
+#define SI4703_REG_READCHAN 0x0B
+#define SI4703_REG_RDSA 0x0C
+#define SI4703_REG_RDSB 0x0D
+#define SI4703_REG_RDSC 0x0E
+#define SI4703_REG_RDSD 0x0F
+
+//Status bits (from the chip)
+#define SI4703_STATUS_RDSR 0x8000
+#define SI4703_STATUS_STC 0x4000
+#define SI4703_STATUS_SFBL 0x2000
+#define SI4703_STATUS_AFCRL 0x1000
+#define SI4703_STATUS_RDSS 0x0800
+#define SI4703_STATUS_ST 0x0100
+
+//Flag bits (to the chip)
+#define SI4703_FLG_DSMUTE 0x8000
+#define SI4703_FLG_DMUTE 0x4000
+#define SI4703_FLG_MONO 0x2000
+#define SI4703_FLG_RDSM 0x0800
+#define SI4703_FLG_SKMODE 0x0400
+#define SI4703_FLG_SEEKUP 0x0200
+#define SI4703_FLG_SEEK 0x0100
+#define SI4703_FLG_DISABLE word(0x0040)
+#define SI4703_FLG_ENABLE word(0x0001)
+#define SI4703_FLG_TUNE 0x8000
+#define SI4703_FLG_RDSIEN 0x8000
+#define SI4703_FLG_STCIEN 0x4000
+#define SI4703_FLG_RDS 0x1000
+#define SI4703_FLG_DE 0x0800
+#define SI4703_FLG_AGCD 0x0400
+#define SI4703_FLG_VOLEXT 0x0100
+#define SI4703_FLG_XOSCEN 0x8000
+#define SI4703_FLG_AHIZEN 0x4000
+
+//Masks and constants for configuration parameters
+#define SI4703_PN_MASK 0xF000
+#define SI4703_PN_SI4700_1 (0x0 << 12)
+#define SI4703_PN_SI4702_3 (0x1 << 12)
+#define SI4703_MFGID_MASK 0x0FFF
+#define SI4703_MFGID_SILABS 0x0242
+#define SI4703_REV_MASK 0xFC00
+#define SI4703_REV_C (0x04 << 10)
+#define SI4703_DEV_MASK 0x03C0
+#define SI4703_DEV_SI4702_OFF (0x0 << 6)
+#define SI4703_DEV_SI4702_ON (0x1 << 6)
+#define SI4703_DEV_SI4703_OFF (0x8 << 6)
+#define SI4703_DEV_SI4703_ON (0x9 << 6)
+#define SI4703_FIRMWARE_MASK word(0x003F)
+#define SI4703_FIRMWARE_OFF 0x00
+#define SI4703_FIRMWARE_ON 0x13
+#define SI4703_CHAN_MASK 0x03FF
+#define SI4703_BLNDADJ_MASK word(0x00C0)
+#define SI4703_BLNDADJ_31_49DB (0x0 << 6)
+#define SI4703_BLNDADJ_37_55DB (0x1 << 6)
+#define SI4703_BLNDADJ_19_37DB (0x2 << 6)
+#define SI4703_BLNDADJ_25_43DB (0x3 << 6)
+#define SI4703_GPIO3_MASK word(0x0030)
+#define SI4703_GPIO3_HIZ (0x0 << 4)
+#define SI4703_GPIO3_ST (0x1 << 4)
+#define SI4703_GPIO3_L (0x2 << 4)
+#define SI4703_GPIO3_H (0x3 << 4)
+#define SI4703_GPIO2_MASK word(0x000C)
+#define SI4703_GPIO2_HIZ (0x0 << 2)
+#define SI4703_GPIO2_INT (0x1 << 2)
+#define SI4703_GPIO2_L (0x2 << 2)
+#define SI4703_GPIO2_H (0x3 << 2)
+#define SI4703_GPIO1_MASK word(0x0003)
+#define SI4703_GPIO1_HIZ 0x0
+#define SI4703_GPIO1_L 0x2
+#define SI4703_GPIO1_H 0x3
+#define SI4703_SEEKTH_MASK 0xFF00
+#define SI4703_SEEKTH_SHIFT 8
+#define SI4703_BAND_MASK word(0x00C0)
+#define SI4703_BAND_WEST (0x0 << 6)
+#define SI4703_BAND_WORLD (0x1 << 6)
+#define SI4703_BAND_EAST (0x2 << 6)
+#define SI4703_SPACE_MASK word(0x0030)
+#define SI4703_SPACE_200K (0x0 << 4)
+#define SI4703_SPACE_100K (0x1 << 4)
+#define SI4703_SPACE_50K (0x2 << 4)
+#define SI4703_VOLUME_MASK word(0x000F)
+#define SI4703_DE_75US 0x0000
+#define SI4703_DE_50US SI4703_FLG_DE
+#define SI4703_SMUTER_MASK 0xC000
+#define SI4703_SMUTER_FASTEST (0x0 << 14)
+#define SI4703_SMUTER_FAST (0x1 << 14)
+#define SI4703_SMUTER_SLOW (0x2 << 14)
+#define SI4703_SMUTER_SLOWEST (0x3 << 14)
+#define SI4703_SMUTEA_MASK 0x3000
+#define SI4703_SMUTEA_16DB (0x0 << 12)
+#define SI4703_SMUTEA_14DB (0x1 << 12)
+#define SI4703_SMUTEA_12DB (0x2 << 12)
+#define SI4703_SMUTEA_10DB (0x3 << 12)
+#define SI4703_SKSNR_MASK word(0x00F0)
+#define SI4703_SKSNR_SHIFT 4
+#define SI4703_SKCNT_MASK word(0x000F)
+#define SI4703_BLERA_MASK 0x0600
+#define SI4703_BLERA_0 (0x0 << 9)
+#define SI4703_BLERA_12 (0x1 << 9)
+#define SI4703_BLERA_35 (0x2 << 9)
+#define SI4703_BLERA_U (0x3 << 9)
+#define SI4703_RSSI_MASK word(0x00FF)
+#define SI4703_BLERB_MASK 0xC000
+#define SI4703_BLERB_0 (0x0 << 14)
+#define SI4703_BLERB_12 (0x1 << 14)
+#define SI4703_BLERB_35 (0x2 << 14)
+#define SI4703_BLERB_U (0x3 << 14)
+#define SI4703_BLERC_MASK 0x3000
+#define SI4703_BLERC_0 (0x0 << 12)
+#define SI4703_BLERC_12 (0x1 << 12)
+#define SI4703_BLERC_35 (0x2 << 12)
+#define SI4703_BLERC_U (0x3 << 12)
+#define SI4703_BLERD_MASK 0x0C00
+#define SI4703_BLERD_0 (0x0 << 10)
+#define SI4703_BLERD_12 (0x1 << 10)
+#define SI4703_BLERD_35 (0x2 << 10)
+#define SI4703_BLERD_U (0x3 << 10)
+#define SI4703_READCHAN_MASK 0x03FF
+
+//RDS group type and version, from block B
+#define SI4703_RDS_GROUP_MASK 0xF800
+#define SI4703_RDS_GROUP_4A 0x4000
+#define SI4703_RDS_GROUP_SHIFT 11
+
+//RDS group filter bits, see Si4703::setRDSFilter(): one per group type and
+//version, e.g. SI4703_RDS_TYPE_A(0) | SI4703_RDS_TYPE_A(2) for 0A and 2A
+#define SI4703_RDS_TYPE_A(type) (1UL << (2 * (type)))
+#define SI4703_RDS_TYPE_B(type) (1UL << (2 * (type) + 1))
+#define SI4703_RDS_TYPE_ALL 0xFFFFFFFFUL
+
+//Block error levels, as reported by the chip in verbose RDS mode
+#define SI4703_BLER_0 0x0
+#define SI4703_BLER_12 0x1
+#define SI4703_BLER_35 0x2
+#define SI4703_BLER_U 0x3
+//Block error levels of a whole group, see Si4703::setRDSErrorTolerance()
+#define SI4703_RDS_BLER(a, b, c, d) ((a) << 6 | (b) << 4 | (c) << 2 | (d))
+#define SI4703_RDS_BLER_A(errors) (((errors) >> 6) & 0x03)
+#define SI4703_RDS_BLER_B(errors) (((errors) >> 4) & 0x03)
+#define SI4703_RDS_BLER_C(errors) (((errors) >> 2) & 0x03)
+#define SI4703_RDS_BLER_D(errors) ((errors) & 0x03)
+
+//Unix time epoch, 1970-01-01, as a Modified Julian Date
+#define SI4703_MJD_UNIX 40587UL
+
+//Seek/tune states, see Si4703::poll()
+#define SI4703_TUNE_IDLE 0
+#define SI4703_TUNE_BUSY 1
+#define SI4703_TUNE_COMPLETE 2
+#define SI4703_TUNE_FAILED 3
+
+//Datasheet-recommended pause between two looks at STC when polling, in ms
+#define SI4703_POLL_INTERVAL 60
+
+//Loudest setVolume() level, see there
+#if SI4703_FEATURE_VOLEXT
+# define SI4703_VOLUME_MAX 30
+#else
+# define SI4703_VOLUME_MAX 15
+#endif
+
+//Interrupt modes, see Si4703::begin()
+#define SI4703_INT_NONE 0
+#define SI4703_INT_DIRECT 1
+#define SI4703_INT_DEFERRED 2
+
+//Power-up sequence stages, see Si4703::startBegin()
+#define SI4703_BEGIN_NONE 0
+#define SI4703_BEGIN_RESET 1
+#define SI4703_BEGIN_OSCILLATOR 2
+#define SI4703_BEGIN_POWERUP 3
+#define SI4703_BEGIN_READY 4
+#define SI4703_BEGIN_SUSPENDED 5
+#define SI4703_BEGIN_RESUME 6
+
+//What bus traffic is accounted to, by API entry point, see Si4703_Stats
+#define SI4703_OP_BEGIN 0
+#define SI4703_OP_TUNE 1
+#define SI4703_OP_POLL 2
+#define SI4703_OP_AUDIO 3
+#define SI4703_OP_PROPERTY 4
+#define SI4703_OP_STATUS 5
+#define SI4703_OP_INTERRUPT 6
+#define SI4703_OP_OTHER 7
+#define SI4703_OPS 8
+#define SI4703_OP_NONE 0xFF
+
+//Latency histograms, see Si4703_Stats; each bucket is twice as wide as the
+//one before and the last one is open-ended.
+#define SI4703_HISTOGRAM_BUCKETS 8
+#define SI4703_HISTOGRAM_INTERRUPT_MICROS 128UL
+#define SI4703_HISTOGRAM_TUNE_MICROS 16000UL
+
+//Commands
+#define SI4703_CMD_SET_PROPERTY 0x07
+#define SI4703_CMD_GET_PROPERTY 0x08
+#define SI4703_CMD_VERIFY_COMMAND 0xFF
+
+//Properties
+#define SI4703_PROP_FM_DETECTOR_SNR 0x0200
+#define SI4703_PROP_BLEND_MONO_RSSI 0x0300
+#define SI4703_PROP_BLEND_STEREO_RSSI 0x0301
+#define SI4703_PROP_CALCODE 0x0700
+#define SI4703_PROP_SNRDB 0x0C00
+
+//PROGMEM channel spacing table, superseded by Si4703_ChannelSpacing() below
+extern const byte Si4703_ChannelSpacings[];
+
+/*
+* Description:
+*   Band and channel arithmetic for every band and channel spacing the chip
+*   supports. With constant arguments it all happens at compile time, e.g.
+*   Si4703_FrequencyToChannel(10110, SI4703_BAND_WEST, SI4703_SPACE_100K) is
+*   simply 136.
+* Parameters:
+*   band      - one of the SI4703_BAND_* constants.
+*   space     - one of the SI4703_SPACE_* constants.
+*   frequency - in 10kHz units, rounded to the nearest channel.
+*/
+constexpr word Si4703_BandBottom(byte band) {
+    return band == SI4703_BAND_WEST ? 8750 : 7600; };
+constexpr word Si4703_BandTop(byte band) {
+    return band == SI4703_BAND_EAST ? 9000 : 10800; };
+constexpr byte Si4703_ChannelSpacing(byte space) {
+    return space == SI4703_SPACE_200K ? 20 :
+           (space == SI4703_SPACE_100K ? 10 : 5); };
+constexpr word Si4703_ChannelToFrequency(word channel, byte band, byte space) {
+    return Si4703_BandBottom(band) + channel * Si4703_ChannelSpacing(space); };
+constexpr word Si4703_FrequencyToChannel(word frequency, byte band,
+                                         byte space) {
+    return (frequency - Si4703_BandBottom(band) +
+            Si4703_ChannelSpacing(space) / 2) / Si4703_ChannelSpacing(space); };
+
+/*
+* Description:
+*   Signature of the function called when an asynchronous seek or tune
+*   completes, see Si4703::setTuneCallback().
+* Parameters:
+*   frequency - the frequency the chip ended up on, in 10kHz units.
+*   failed    - the chip reported SF/BL: the seek hit the band limit or
+*               wrapped around without finding a valid channel.
+*/
+typedef void (*Si4703_TuneCallback)(word frequency, bool failed);
+
+/*
+* Description:
+*   Signature of the function called to route the I2C bus to a given chip,
+*   e.g. by programming an I2C multiplexer, see Si4703::setBusSelector().
+* Parameters:
+*   bus - whatever was given to setBusSelector(), typically a mux channel.
+*/
+typedef void (*Si4703_BusSelector)(byte bus);
+
+/*
+* Description:
+*   RDS reception statistics, see Si4703::getRDSStats().
+*   accepted - groups stored in the ring for the application.
+*   rejected - groups thrown away because of block errors, see
+*              Si4703::setRDSErrorTolerance().
+*   dropped  - good groups lost because the ring was full, and in
+*              SI4703_INT_DEFERRED mode groups replaced by the next one
+*              before service() got to them.
+*   filtered - good groups of types left out by Si4703::setRDSFilter().
+*/
+typedef struct {
+    unsigned long accepted;
+    unsigned long rejected;
+    unsigned long dropped;
+    unsigned long filtered;
+} Si4703_RDSStats;
+
+/*
+* Description:
+*   Wall clock time from RDS group 4A (Clock Time), see
+*   Si4703::getClockTime().
+*   utc    - seconds since 1970-01-01 00:00 UTC (Unix time).
+*   millis - and milliseconds.
+*   offset - local time offset from UTC, in half hours.
+*   age    - how long ago the group came in, in ms. Broadcasters send one a
+*            minute, with the minute edge within 100ms of its end.
+*/
+typedef struct {
+    unsigned long utc;
+    word millis;
+    int8_t offset;
+    unsigned long age;
+} Si4703_ClockTime;
+
+/*
+* Description:
+*   Instrumentation counters, see Si4703::getStats().
+*   transactions, bytes   - I2C traffic (address bytes included) by
+*                           SI4703_OP_* entry point. Work done on behalf of
+*                           another entry point counts towards the outermost
+*                           one, interrupts and service() count as
+*                           SI4703_OP_INTERRUPT.
+*   commandSpins          - register reads spent waiting for the command
+*                           processor.
+*   waitSpins             - iterations of the blocking waits in begin(),
+*                           setFrequency() and the seeks.
+*   interrupts            - ISR invocations, of which interruptMicros is the
+*                           total and interruptMax the longest duration.
+*   tunes                 - seeks and tunes completed, of which tuneMicros
+*                           is the total and tuneMax the longest duration.
+*   *Histogram            - the same durations, bucket 0 counting those under
+*                           SI4703_HISTOGRAM_*_MICROS.
+*/
+typedef struct {
+    unsigned long transactions[SI4703_OPS];
+    unsigned long bytes[SI4703_OPS];
+    unsigned long commandSpins;
+    unsigned long waitSpins;
+    unsigned long interrupts;
+    unsigned long interruptMicros;
+    unsigned long interruptMax;
+    unsigned long tunes;
+    unsigned long tuneMicros;
+    unsigned long tuneMax;
+    word interruptHistogram[SI4703_HISTOGRAM_BUCKETS];
+    word tuneHistogram[SI4703_HISTOGRAM_BUCKETS];
+} Si4703_Stats;
+
+class Si4703Telemetry;
+class Si4703Trace;
+
+class Si4703
+{
+    public:
+        /*
+        * Description:
+        *   This the constructor. It assumes SparkFun Si4703 Evaluation or
+        *   Breakout Board + level shifter (or 3.3V-native Arduino) semantics
+        *   if called without parameters.
+        *   If you're not using the SparkFun Evaluation or Breakout Boards or
+        *   have wired the Si4703 differently, then explicitly supply the
+        *   constructor with the actual pin numbers.
+        *   Use the hardwired pins constants above to tell the constructor you
+        *   haven't used (and hardwired) some of the pins.
+        * Parameters:
+        *   pin*      - pin numbers for connections to the Si4703, with
+        *               defaults for the SparkFun Evaluation or Breakout 
+        *               Boards already provided.
+        */
+        Si4703(byte pinReset = SI4703_PIN_RESET,
+               byte pinGPIO2 = SI4703_PIN_GPIO2, byte pinSEN = SI4703_PIN_SEN);
+
+        /*
+        * Description:
+        *   This is the destructor, it delegates to end().
+        */
+        ~Si4703() { end(); };
+
+        /*
+        * Description:
+        *   Initializes the Si4703 and powers up the radio with the desired
+        *   band limits.
+        *   This function must be called before any other radio command.
+        * Parameters:
+        *   band        - the desired FM band, one of the SI4703_BAND_*
+        *                 constants.
+        *   xosc        - a 32768Hz external oscillator is present.
+        *   interrupt   - interrupt mode is to be used (as opposed to polling)
+        *                 when waiting for the chip to perform an operation,
+        *                 one of the SI4703_INT_* constants (true and false
+        *                 still work and mean DIRECT and NONE respectively).
+        *                 SI4703_INT_DIRECT talks to the chip from within the
+        *                 ISR, SI4703_INT_DEFERRED only flags the interrupt
+        *                 and leaves the bus work to service(). Up to
+        *                 SI4703_MAX_INSTANCES objects can use interrupts,
+        *                 any more fall back to polling. GPIO2 must be on an
+        *                 external interrupt pin, or on any pin with a pin
+        *                 change interrupt if the sketch includes
+        *                 Si4703PCINT.h; otherwise polling is used.
+        *                 Built without SI4703_FEATURE_INTERRUPTS, it is
+        *                 always polling.
+        */
+        void begin(byte band, bool xosc = true,
+                   byte interrupt = SI4703_INT_DIRECT);
+
+        /*
+        * Description:
+        *   Asynchronous version of begin(): it puts the chip in reset and
+        *   returns immediately, leaving poll() to walk it through the rest of
+        *   the power-up sequence (reset -> oscillator -> power-up -> configure)
+        *   as the datasheet delays elapse. That is over 600ms during which
+        *   the rest of the system can be brought up.
+        *   Other radio commands must wait until isReady() returns true.
+        * Parameters:
+        *   see begin().
+        */
+        void startBegin(byte band, bool xosc = true,
+                        byte interrupt = SI4703_INT_DIRECT);
+
+        /*
+        * Description:
+        *   Returns true once the power-up sequence has completed.
+        */
+        bool isReady(void) { return _beginStage == SI4703_BEGIN_READY; };
+
+        /*
+        * Description:
+        *   Gets the frequency the chip is currently tuned to.
+        * Returns:
+        *   frequency in 10kHz units.
+        */
+        word getFrequency(void);
+
+        /*
+        * Description:
+        *   Tunes directly to frequency, which takes about 60ms as opposed to
+        *   up to several seconds for a seek.
+        * Parameters:
+        *   frequency - in 10kHz units, rounded to the nearest channel of the
+        *               current band and spacing.
+        * Returns:
+        *   false without side-effects if frequency is outside the current
+        *   band or a seek/tune is already underway.
+        */
+        bool setFrequency(word frequency);
+
+        /*
+        * Description:
+        *   Asynchronous version of setFrequency(), see startSeekUp().
+        */
+        bool startSetFrequency(word frequency);
+
+        /*
+        * Description:
+        *   Changes band limits and channel spacing. The chip stays on the
+        *   same channel number, so retune afterwards.
+        * Parameters:
+        *   band  - one of the SI4703_BAND_* constants.
+        *   space - one of the SI4703_SPACE_* constants.
+        */
+        void setBand(byte band, byte space = SI4703_SPACE_100K);
+
+        /*
+        * Description:
+        *   Accessors for the current band and channel spacing, as
+        *   SI4703_BAND_* and SI4703_SPACE_* constants respectively.
+        */
+        byte getBand(void) {
+            return _registers[SI4703_REG_SYSCONFIG2] & SI4703_BAND_MASK; };
+        byte getSpacing(void) {
+            return _registers[SI4703_REG_SYSCONFIG2] & SI4703_SPACE_MASK; };
+
+        /*
+        * Description:
+        *   Commands the radio to seek up to the next valid channel.
+        * Parameters:
+        *   wrap - set to true to allow the seek to wrap around the current
+        *          band.
+        */
+        void seekUp(bool wrap = true);
+
+        /*
+        * Description:
+        *   Commands the radio to seek down to the next valid channel.
+        * Parameters:
+        *   wrap - set to true to allow the seek to wrap around the current
+        *          band.
+        */
+        void seekDown(bool wrap = true);
+
+        /*
+        * Description:
+        *   Asynchronous versions of seekUp() and seekDown(): they start the
+        *   seek and return immediately, leaving poll() to track its progress.
+        *   Return false without side-effects if a seek is already underway.
+        */
+        bool startSeekUp(bool wrap = true) { return startSeek(true, wrap); };
+        bool startSeekDown(bool wrap = true) { return startSeek(false, wrap); };
+
+        /*
+        * Description:
+        *   Advances the power-up sequence started by startBegin(), if any.
+        *   Advances the seek/tune state machine and never blocks: in polling
+        *   mode it looks at STC at most every SI4703_POLL_INTERVAL ms and
+        *   costs a single-register read when it does; in interrupt mode it
+        *   only looks at what the ISR already fetched (calling service()
+        *   first in deferred interrupt mode). On completion, the
+        *   callback (if any) is invoked from within poll(). Call it often,
+        *   e.g. from loop().
+        * Returns:
+        *   one of the SI4703_TUNE_* constants.
+        */
+        byte poll(void);
+
+        /*
+        * Description:
+        *   Does the work the ISR defers in SI4703_INT_DEFERRED mode: if GPIO2
+        *   fired since the last call, reads the status (and RDS, if enabled)
+        *   registers, queues any good RDS group and completes a pending
+        *   seek/tune. All bus traffic thus stays in the main context. poll()
+        *   and readRDSGroup() call it for you, but call it from loop() anyway
+        *   if you do neither often: the chip only holds one RDS group, so
+        *   one arriving before the previous interrupt was serviced replaces
+        *   it and is counted as dropped (seek/tune completion interrupts
+        *   carry no group and are not). Does nothing in the other modes.
+        * Returns:
+        *   true if there was an interrupt to service.
+        */
+        bool service(void);
+
+        /*
+        * Description:
+        *   Reads the status (and RDS, if enabled) registers right away and
+        *   does with them what service() would. This is how RDS gets
+        *   received in polling mode, see Si4703Scheduler. Must not be used
+        *   in SI4703_INT_DIRECT mode, where the ISR may be on the bus.
+        */
+        void refresh(void) { refreshAt(micros()); };
+
+        byte getInterruptMode(void) { return _interrupt; };
+
+        /*
+        * Description:
+        *   Puts this chip behind a bus selector (e.g. one channel of a
+        *   TCA9548A I2C multiplexer) so that several of them, all answering
+        *   to the same address, can share one I2C bus. The selector is only
+        *   called when a different chip than last time is to be talked to.
+        *   As the ISR must not switch the bus from under the main context,
+        *   SI4703_INT_DIRECT is downgraded to SI4703_INT_DEFERRED. Call
+        *   before begin().
+        * Parameters:
+        *   selector - the routing function, NULL if the chip is directly on
+        *              the bus.
+        *   bus      - passed on to selector.
+        */
+        void setBusSelector(Si4703_BusSelector selector, byte bus);
+
+#if SI4703_FEATURE_INTERRUPTS
+        /*
+        * Description:
+        *   Instrumentation: microseconds between the last deferred interrupt
+        *   and the service() call that handled it.
+        */
+        unsigned long getServiceLatency(void) { return _serviceLatency; };
+
+        /*
+        * Description:
+        *   Pin change interrupt support, for Si4703PCINT.h only:
+        *   enablePinChange() says the PCINTn_vect handlers are in place
+        *   and dispatchPinChange() is what they call, finding the instances
+        *   whose GPIO2 is in that bank and just went low.
+        * Parameters:
+        *   bank - the PCICR bit of the vector that fired.
+        */
+        static bool enablePinChange(void) { return _pinChange = true; };
+        static void dispatchPinChange(byte bank);
+#endif
+
+        /*
+        * Description:
+        *   Status query for asynchronous seeks: the last value returned by
+        *   poll() and, once that is no longer SI4703_TUNE_BUSY, the frequency
+        *   (in 10kHz units) the chip ended up on.
+        */
+        byte getTuneState(void) { return _tuneState; };
+        word getTuneFrequency(void) { return _tuneFrequency; };
+
+        /*
+        * Description:
+        *   Registers a function to be called when a seek completes, pass NULL
+        *   to remove it.
+        */
+        void setTuneCallback(Si4703_TuneCallback callback) {
+            _tuneCallback = callback; };
+
+        /*
+        * Description:
+        *   Keeps the telemetry sampler, if any, from sampling while the chip
+        *   only visits another channel, e.g. to probe an alternative
+        *   frequency, so the station listened to is all it reports on.
+        *   Tunes and seeks under way are never sampled.
+        */
+        void holdTelemetry(bool hold);
+
+        /*
+        * Description:
+        *   Retrieves the Received Signal Strength Indication measurement for
+        *   the currently tuned station.
+        */
+        byte getRSSI(void);
+
+        /*
+        * Description:
+        *   Increase the volume by 1, see setVolume(). If the maximum volume
+        *   has been reached, no further increase will take place and returns
+        *   false; otherwise true.
+        */
+        bool volumeUp(void);
+
+        /*
+        * Description:
+        *   Decrease the volume by 1. If the minimum volume has been
+        *   reached, no further decrease will take place and returns false;
+        *   otherwise true.
+        * Parameters:
+        *   alsomute - mute the output when reaching minimum volume, in
+        *               addition to returning false
+        */
+        bool volumeDown(bool alsomute = false);
+
+        /*
+        * Description:
+        *   Mutes the audio output.
+        */
+        void mute(void);
+
+        /*
+        * Description:
+        *   Unmutes the audio output.
+        * Parameters:
+        *   minvol - set the volume to 1, the quietest audible level, before
+        *            unmuting if true, otherwise leave it untouched causing
+        *            the chip to blast audio out at whatever the previous
+        *            volume level was.
+        */
+        void unMute(bool minvol = false);
+
+        /*
+        * Description:
+        *   Whether the audio output is muted, as last set by mute() and
+        *   unMute().
+        */
+        bool isMuted(void) {
+            return !(_registers[SI4703_REG_POWERCFG] & SI4703_FLG_DMUTE); };
+
+        /*
+        * Description:
+        *   Sets the volume in one go rather than one volumeUp()/volumeDown()
+        *   at a time. Levels 1 to 15 are the extended range (VOLEXT), 30dB
+        *   below levels 16 to 30 of the normal one; built without
+        *   SI4703_FEATURE_VOLEXT there is only the normal range, as levels 1
+        *   to 15. Level 0 is silence.
+        * Parameters:
+        *   level - 0 to SI4703_VOLUME_MAX.
+        * Returns:
+        *   false without side-effects if level is out of range.
+        */
+        bool setVolume(byte level);
+        byte getVolume(void);
+
+        /*
+        * Description:
+        *   Forces mono output, or lets the chip blend to stereo as the
+        *   signal allows.
+        */
+        void setMono(bool mono);
+
+        /*
+        * Description:
+        *   Sets the de-emphasis, one of the SI4703_DE_* constants: 75us in
+        *   the Americas and South Korea, 50us everywhere else.
+        */
+        void setDeemphasis(word deemphasis);
+
+        /*
+        * Description:
+        *   Sets what a seek accepts as a valid channel, see the Si4703 seek
+        *   settings application note (AN284) for recommended values.
+        * Parameters:
+        *   rssi  - SEEKTH, minimum RSSI in dBuV.
+        *   snr   - SKSNR, SNR threshold from 1 (most stops) to 15 (fewest
+        *           stops), 0 disables the check.
+        *   count - SKCNT, FM impulse detection threshold from 1 (most
+        *           stops) to 15 (fewest stops), 0 disables the check.
+        */
+        void setSeekThresholds(byte rssi, byte snr, byte count);
+
+        /*
+        * Description:
+        *   Groups configuration changes into one write. Between
+        *   beginTransaction() and commitTransaction() volume, mute, mono,
+        *   de-emphasis, seek threshold and band changes only go to the
+        *   register shadow; commitTransaction() sends them to the chip
+        *   together. Anything else that talks to the chip in between (a
+        *   tune or seek, say) sends them along with its own.
+        */
+        void beginTransaction(void) { _transaction = true; };
+        void commitTransaction(void);
+
+        /*
+        * Description:
+        *   Mutes and disables the chip.
+        */
+        void end(void);
+
+        /*
+        * Description:
+        *   Powers the chip down to save power, keeping the oscillator
+        *   running. Where it was tuned to and every setting stay in the
+        *   register shadow, a seek or tune under way is abandoned. Radio
+        *   commands wait for resume(), as they do for begin(). Properties
+        *   are not kept, set them again after resume().
+        */
+        void suspend(void);
+
+        /*
+        * Description:
+        *   Powers a suspend()-ed chip back up with one write and retunes it
+        *   where it was: a wake-to-audio cycle is the datasheet power-up
+        *   time plus a tune, no reset, oscillator wait or register reads.
+        *   Returns once the tune is complete.
+        */
+        void resume(void);
+
+        /*
+        * Description:
+        *   Asynchronous version of resume(): poll() walks the chip through
+        *   power-up and starts the tune, isReady() returns true once it has.
+        * Returns:
+        *   false without side-effects if the chip is not suspended.
+        */
+        bool startResume(void);
+
+#if SI4703_FEATURE_COMMANDS
+        /*
+        * Description:
+        *   Sets a property value, see the SI4703_PROP_* constants and the
+        *   Si4703 Datasheet for more information.
+        * Returns:
+        *   false if the command processor did not answer in time.
+        */
+        bool setProperty(word property, word value);
+
+        /*
+        * Description:
+        *   Gets a property value, see the SI4703_PROP_* constants and the
+        *   Si4703 Datasheet for more information. The last
+        *   SI4703_PROPERTY_CACHE_SIZE properties set are remembered until the
+        *   chip is reset or powered down, and asking for them again costs
+        *   neither bus traffic nor an RDS outage. Properties only ever read,
+        *   such as the ones the chip updates on its own, always come from
+        *   the chip.
+        * Parameters:
+        *   fresh - ask the chip even if the value is known.
+        * Returns:
+        *   The current value of property, 0 if the command processor did not
+        *   answer in time.
+        */
+        word getProperty(word property, bool fresh = false);
+
+        /*
+        * Description:
+        *   Batches property operations. The command processor shares the RDS
+        *   registers, so each setProperty()/getProperty() normally turns RDS
+        *   off, wakes the command processor up and turns RDS back on again.
+        *   Between beginCommands() and endCommands() that is done only once
+        *   for all of them. Issue no other radio commands in between.
+        * Returns:
+        *   beginCommands() - false if the command processor did not come up,
+        *                     in which case there is no batch to end.
+        *   endCommands()   - false if any command in the batch timed out.
+        */
+        bool beginCommands(void);
+        bool endCommands(void);
+
+        /*
+        * Description:
+        *   Instrumentation: how long the last batch (or lone property
+        *   operation) kept RDS off, in microseconds.
+        */
+        unsigned long getCommandLatency(void) { return _commandLatency; };
+#endif
+
+        /*
+        * Description:
+        *   Accessor for the status register.
+        */
+        word getStatus(void) { return _registers[SI4703_REG_STATUSRSSI]; };
+
+#if SI4703_FEATURE_RDS
+        /*
+        * Description:
+        *   If the chip has received any valid RDS group, fetch the oldest one
+        *   and fill word block[4] with it, returning true; otherwise return
+        *   false without side-effects.
+        *   As RDS has a [mandated by standard] constant transmission rate of
+        *   11.4 groups per second, you should actively call this function (e.g.
+        *   from loop()) so that you read most if not all of the error-corrected
+        *   RDS groups received. Up to SI4703_RDS_RING_SIZE - 1 groups are kept
+        *   in between calls, anything arriving past that is dropped and
+        *   counted as such. For example:
+        *   loop() {
+        *     if(Si4703::readRDSGroup(data))
+        *       RDSDecoder::decodeRDSGroup(data);
+        *   }
+        * Parameters:
+        *   stamp  - set to micros() when the chip signalled the group: at
+        *            the interrupt in interrupt mode, at refresh() when
+        *            polling.
+        *   errors - set to the block error levels the chip reported for the
+        *            group, see SI4703_RDS_BLER_A() and friends.
+        */
+        bool readRDSGroup(word* block);
+        bool readRDSGroup(word* block, unsigned long &stamp);
+        bool readRDSGroup(word* block, unsigned long &stamp, byte &errors);
+
+        /*
+        * Description:
+        *   Picks the RDS group types that go into the ring, by block B. The
+        *   others are counted and thrown away by the ISR, leaving the ring
+        *   to the groups the application decodes. Clock Time is kept
+        *   whatever the filter, see getClockTime(). Defaults to
+        *   SI4703_RDS_TYPE_ALL.
+        * Parameters:
+        *   groups - SI4703_RDS_TYPE_A() and SI4703_RDS_TYPE_B() bits, or'ed
+        *            together.
+        */
+        void setRDSFilter(unsigned long groups);
+
+        /*
+        * Description:
+        *   Sets the worst block error level accepted in each block of a
+        *   group, worse groups are counted and thrown away by the ISR. The
+        *   default, SI4703_RDS_BLER(SI4703_BLER_0, SI4703_BLER_0,
+        *   SI4703_BLER_0, SI4703_BLER_0), only takes groups received
+        *   without errors; the chip corrects up to 5 bit errors in a block,
+        *   so allowing for SI4703_BLER_12 keeps more groups on weak
+        *   stations at little risk. Block B gives the group type, so errors
+        *   let through there can get groups past setRDSFilter() as another
+        *   type, and SI4703_BLER_U anywhere lets corrupt groups through.
+        * Parameters:
+        *   tolerance - SI4703_RDS_BLER() of one SI4703_BLER_* per block.
+        */
+        void setRDSErrorTolerance(byte tolerance) {
+            _rdsTolerance = tolerance; };
+
+        /*
+        * Description:
+        *   Bulk version of readRDSGroup(): drains up to n groups, oldest first,
+        *   into block and their stamps, if asked for, into stamps.
+        * Returns:
+        *   The number of groups copied.
+        */
+        byte readRDSGroups(word block[][4], byte n,
+                           unsigned long *stamps = NULL);
+
+        /*
+        * Description:
+        *   The current time according to the last Clock Time group received,
+        *   advanced by how long ago that group came in. Groups are decoded as
+        *   they are received rather than when loop() gets to them, so this
+        *   is as good as the group's stamp (see readRDSGroup()) and
+        *   millis(), whatever the state of the ring. Only groups with
+        *   blocks B, C and D received without errors set the clock,
+        *   whatever setRDSErrorTolerance() lets into the ring. Local time
+        *   is utc + offset * 1800.
+        * Returns:
+        *   false if no Clock Time group has been received yet.
+        */
+        bool getClockTime(Si4703_ClockTime &time);
+
+        /*
+        * Description:
+        *   Copies the RDS reception counters into stats. They count since
+        *   construction; sample them twice and subtract to get a rate.
+        */
+        void getRDSStats(Si4703_RDSStats &stats);
+#endif
+
+        /*
+        * Description:
+        *   Instrumentation counter: the number of bytes that were not sent to
+        *   the chip since construction because only the registers that
+        *   changed were written. Sample it before and after a call to get the
+        *   savings for that call.
+        */
+        unsigned long getWriteBytesSaved(void) { return _writeBytesSaved; };
+
+#if SI4703_INSTRUMENTATION
+        /*
+        * Description:
+        *   Copies the instrumentation counters into stats, or zeroes them.
+        *   Only there when built with SI4703_INSTRUMENTATION.
+        */
+        void getStats(Si4703_Stats &stats);
+        void resetStats(void);
+#endif
+
+    private:
+        //Restores presets straight into the register shadow
+        friend class Si4703Presets;
+        //Samples every register read
+        friend class Si4703Telemetry;
+        //Records every transaction
+        friend class Si4703Trace;
+
+        byte _pinReset, _pinGPIO2, _pinSEN;
+        byte _interrupt;
+        Si4703_BusSelector _selector;
+        Si4703Telemetry *_telemetry;
+        Si4703Trace *_trace;
+        byte _bus;
+        volatile word _registers[SI4703_SHADOW_SIZE];
+        volatile word _dirty;
+        unsigned long _writeBytesSaved;
+        byte _tuneState;
+        word _tuneFrequency;
+        unsigned long _tuneStamp;
+        Si4703_TuneCallback _tuneCallback;
+        byte _beginStage, _beginBand;
+        bool _transaction;
+        bool _xosc;
+        unsigned long _beginStamp, _beginWait;
+#if SI4703_FEATURE_COMMANDS
+        word _response[4];
+        bool _commandBatch, _commandRDS, _commandFailed;
+        unsigned long _commandStamp, _commandLatency;
+        //Property cache, filled in round-robin
+        word _propertyIds[SI4703_PROPERTY_CACHE_SIZE];
+        word _propertyValues[SI4703_PROPERTY_CACHE_SIZE];
+        byte _propertyCount, _propertyNext;
+#endif
+#if SI4703_FEATURE_RDS
+        //Single producer (the ISR) advances _rdsHead, single consumer
+        //(readRDSGroup()) advances _rdsTail; both are bytes so either side
+        //reads the other's index atomically.
+        volatile word _rdsRing[SI4703_RDS_RING_SIZE][4];
+        //micros() when each group in the ring was signalled
+        volatile unsigned long _rdsArrivals[SI4703_RDS_RING_SIZE];
+        //And the block error levels it came with
+        volatile byte _rdsErrors[SI4703_RDS_RING_SIZE];
+        //setRDSFilter() bits, least significant byte first
+        volatile byte _rdsFilter[4];
+        volatile byte _rdsTolerance;
+        volatile byte _rdsHead, _rdsTail;
+        volatile Si4703_RDSStats _rdsStats;
+        unsigned long _rdsStamp;
+        //Last Clock Time: the minute it gave, as Unix time (0 for none yet),
+        //when it came in, by millis(), and the local time offset
+        volatile unsigned long _clockUTC, _clockMillis;
+        volatile int8_t _clockOffset;
+#endif
+#if SI4703_INSTRUMENTATION
+        volatile Si4703_Stats _stats;
+        //The SI4703_OP_* bus traffic is being accounted to
+        volatile byte _op;
+        unsigned long _tuneStart;
+#endif
+#if SI4703_FEATURE_INTERRUPTS
+        byte _slot;
+        //Interrupts since the last service()
+        volatile byte _pending;
+        volatile unsigned long _pendingStamp;
+        //Level of GPIO2 at the last pin change, to tell the edges apart
+        volatile bool _gpio2High;
+        unsigned long _serviceLatency;
+        //Interrupt dispatch: attachInterrupt() handlers take no arguments, so
+        //each slot gets its own trampoline to find its object by.
+        static Si4703 *_instances[SI4703_MAX_INSTANCES];
+        static void (* const _trampolines[SI4703_MAX_INSTANCES])(void);
+        //Set once Si4703PCINT.h has been included
+        static bool _pinChange;
+#endif
+        //Whoever last had the bus routed to it
+        static Si4703 *_busOwner;
+
+#if SI4703_FEATURE_COMMANDS
+        /*
+        * Description:
+        *   Used to send a command and its arguments to the radio chip.
+        *   Outside of a batch, the command processor is brought up and torn
+        *   down around it.
+        * Parameters:
+        *   command - the command byte, see datasheet and use one of the
+        *             SI4703_CMD_* constants
+        *   arg1-7  - command arguments, see the Si4703 Programmers Guide.
+        * Returns:
+        *   false if the command processor did not answer in time.
+        */
+        bool sendCommand(byte command, byte arg0 = 0, byte arg1 = 0,
+                         byte arg2 = 0, byte arg3 = 0, byte arg4 = 0,
+                         byte arg5 = 0, byte arg6 = 0);
+
+        /*
+        * Description:
+        *   Re-reads the registers until the bits in mask clear in RDSD, for
+        *   at most SI4703_COMMAND_MICROS.
+        * Returns:
+        *   false on timeout.
+        */
+        bool waitCommand(word mask);
+
+        /*
+        * Description:
+        *   Looks property up in the cache, or puts it there.
+        * Returns:
+        *   findProperty() - its index, SI4703_PROPERTY_CACHE_SIZE if absent.
+        */
+        byte findProperty(word property);
+        void cacheProperty(word property, word value);
+#endif
+
+        /*
+        * Description:
+        *   Update the register file in bulk as the Si4703 doesn't support
+        *   random access to its registers via I2C. Writes stop at the last
+        *   dirty register and are skipped altogether if there is none.
+        * Parameters:
+        *   last - the last register to read. Reads always start at
+        *          STATUSRSSI (0xA) and wrap around after RDSD (0xF), so ask
+        *          for as little as the caller actually consumes.
+        */
+        void getRegisterBulk(byte last = SI4703_REG_RDSD);
+        void setRegisterBulk(void);
+
+        /*
+        * Description:
+        *   setRegisterBulk() for configuration changes: held back until
+        *   commitTransaction() inside a transaction.
+        */
+        void updateRegisters(void) { if(!_transaction) setRegisterBulk(); };
+
+        /*
+        * Description:
+        *   Calls the bus selector, if any and if needed.
+        */
+        void selectBus(void);
+
+#if SI4703_INSTRUMENTATION
+        /*
+        * Description:
+        *   Accounts for a transaction of count bytes (address byte not
+        *   included) and for the duration of an interrupt or tune.
+        */
+        void countTransfer(byte count);
+        void countInterrupt(unsigned long duration);
+        void countTune(unsigned long duration);
+#endif
+
+        /*
+        * Description:
+        *   Modify the shadow register file and mark the register dirty so
+        *   that the next setRegisterBulk() sends it to the chip.
+        */
+        void setRegister(byte reg, word value) {
+            _registers[reg] = value; _dirty |= bit(reg); };
+        void setFlags(byte reg, word flags) {
+            setRegister(reg, _registers[reg] | flags); };
+        void clearFlags(byte reg, word flags) {
+            setRegister(reg, _registers[reg] & ~flags); };
+
+        /*
+        * Description:
+        *   Steps of the power-up sequence: waitBegin() records which stage
+        *   comes next and how long to wait for it, advanceBegin() runs it
+        *   once the wait is over.
+        */
+        void waitBegin(byte stage, unsigned long wait);
+        void advanceBegin(void);
+
+        /*
+        * Description:
+        *   Puts a setVolume() level into the register shadow, touching only
+        *   the fields that change.
+        */
+        void storeVolume(byte level);
+
+        /*
+        * Description:
+        *   Programs the seek direction and wrap mode and starts the seek.
+        */
+        bool startSeek(bool up, bool wrap);
+
+        /*
+        * Description:
+        *   Computes the frequency of the channel in the READCHAN shadow, in
+        *   10kHz units.
+        */
+        word channelFrequency(void);
+
+        /*
+        * Description:
+        *   Performs actions common to all tuning modes: startTune() arms the
+        *   state machine, completeTune() blocks until poll() says it's done
+        *   and finishTune() is what poll() does once STC is seen.
+        */
+        void startTune(void);
+        void completeTune(void);
+        void finishTune(void);
+
+        /*
+        * Description:
+        *   Brings in the registers an interrupt may be about: everything up
+        *   to RDSD if RDS is enabled, STATUSRSSI otherwise.
+        */
+        void getInterruptRegisters(void);
+
+        /*
+        * Description:
+        *   What service() and refresh() do, stamp being when the chip
+        *   signalled whatever there is to read.
+        */
+        void refreshAt(unsigned long stamp);
+
+#if SI4703_FEATURE_RDS
+        /*
+        * Description:
+        *   Queues the RDS group just read, if any and if good enough, and
+        *   sets the clock from it if it is a Clock Time group.
+        * Parameters:
+        *   stamp - micros() when the chip signalled it.
+        */
+        void storeRDSGroup(unsigned long stamp);
+        void storeClockTime(unsigned long stamp);
+#endif
+
+#if SI4703_FEATURE_INTERRUPTS
+        /*
+        * Description:
+        *   Finds a free interrupt slot and hooks GPIO2 up to it, or frees it.
+        * Returns:
+        *   false if all SI4703_MAX_INSTANCES slots are taken.
+        */
+        bool attachSlot(void);
+        void detachSlot(void);
+
+        /*
+        * Description:
+        *   Hooks GPIO2 up to the slot attachSlot() found, once the chip has
+        *   been told to raise interrupts there.
+        */
+        void hookSlot(void);
+
+        /*
+        * Description:
+        *   Whether GPIO2 is on a pin change interrupt rather than an external
+        *   interrupt pin.
+        */
+        bool isPinChange(void);
+
+        /*
+        * Description:
+        *
+        * Services interrupts from the Si4703. In SI4703_INT_DEFERRED mode it
+        * notes the time and leaves everything else to service().
+        */
+        void interruptServiceRoutine(void);
+
+        /*
+        * Description:
+        *   The trampolines, see _trampolines above.
+        */
+        static void dispatchInterrupt0(void);
+        static void dispatchInterrupt1(void);
+        static void dispatchInterrupt2(void);
+        static void dispatchInterrupt3(void);
+#endif
+};
+
+#endif
@@ -0,0 +1,232 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the code file for the RDS alternative frequency follower.
+ * See the header file for better function documentation.
+ */
+
+#include "Si4703.h"
+
+//The Arduino IDE builds every file of the library, wanted or not
+#if SI4703_FEATURE_RDS
+
+#include "Si4703AF.h"
+
+//What poll() is waiting for
+#define SI4703AF_STEP_WAIT 0
+#define SI4703AF_STEP_PROBE 1
+#define SI4703AF_STEP_VERIFY 2
+#define SI4703AF_STEP_RETURN 3
+#define SI4703AF_STEP_BACK 4
+
+Si4703AF::Si4703AF(Si4703 &radio) : _radio(radio) {
+    _state = SI4703_AF_IDLE;
+    _step = SI4703AF_STEP_WAIT;
+    _stopping = false;
+    _home = 0;
+    _probes = _switches = 0;
+    forget();
+}
+
+void Si4703AF::start(byte threshold, byte margin, word interval,
+                     word piWait) {
+    _threshold = threshold;
+    _margin = margin;
+    _interval = interval;
+    _piWait = piWait;
+    _stopping = false;
+    _stamp = millis();
+    //Lists learned before may carry the tuned frequency
+    _home = _radio.getFrequency();
+    for(byte i = 0; i < _count; i++)
+        if(codeFrequency(_codes[i]) == _home) remove(i);
+    if(_state == SI4703_AF_IDLE) _state = SI4703_AF_LISTENING;
+}
+
+void Si4703AF::stop(void) {
+    if(_state == SI4703_AF_PROBING) _stopping = true;
+    else _state = SI4703_AF_IDLE;
+}
+
+void Si4703AF::process(const word *block, byte errors) {
+    if(_state == SI4703_AF_PROBING || SI4703_RDS_BLER_A(errors)) return;
+
+    if(block[0] != _pi) {
+        forget();
+        _pi = block[0];
+    };
+    //Only 0A carries AF lists in block C; B must be right to tell it is 0A
+    if(block[1] >> SI4703_RDS_GROUP_SHIFT || SI4703_RDS_BLER_B(errors) ||
+       SI4703_RDS_BLER_C(errors))
+        return;
+    //A LF/MF frequency follows its marker in the same block
+    if(highByte(block[2]) != SI4703_AF_CODE_LFMF) {
+        learn(highByte(block[2]));
+        learn(lowByte(block[2]));
+    };
+}
+
+byte Si4703AF::poll(void) {
+    word block[4];
+    unsigned long stamp;
+    byte errors;
+
+    switch(_step) {
+        case SI4703AF_STEP_WAIT:
+            if(_state != SI4703_AF_LISTENING || !_count ||
+               millis() - _stamp < _interval ||
+               _radio.getTuneState() == SI4703_TUNE_BUSY)
+                break;
+            _stamp = millis();
+            probe();
+            break;
+        case SI4703AF_STEP_PROBE: {
+            const byte tune = _radio.poll();
+
+            if(tune == SI4703_TUNE_BUSY) break;
+
+            const word status = _radio.getStatus();
+
+            _rssi[_current] = status & SI4703_RSSI_MASK;
+            if(tune == SI4703_TUNE_COMPLETE &&
+               !(status & SI4703_STATUS_AFCRL) &&
+               _rssi[_current] >= _homeRSSI + _margin) {
+                //The tune flushed the RDS ring, all of it is from here
+                _stamp = millis();
+                _step = SI4703AF_STEP_VERIFY;
+            } else
+                goBack();
+            break;
+        };
+        case SI4703AF_STEP_VERIFY:
+            while(_step == SI4703AF_STEP_VERIFY &&
+                  _radio.readRDSGroup(block, stamp, errors))
+                if(!SI4703_RDS_BLER_A(errors)) {
+                    if(block[0] == _pi) commit();
+                    else {
+                        //Kept on the list, or the next AF list would
+                        //bring it back
+                        _rssi[_current] = SI4703_AF_RSSI_OTHER;
+                        goBack();
+                    };
+                };
+            if(_step == SI4703AF_STEP_VERIFY && millis() - _stamp >= _piWait)
+                goBack();
+            break;
+        case SI4703AF_STEP_RETURN:
+            if(_radio.poll() != SI4703_TUNE_BUSY) finish();
+            break;
+        case SI4703AF_STEP_BACK:
+            goBack();
+            break;
+    };
+
+    return _state;
+}
+
+void Si4703AF::forget(void) {
+    _pi = 0x0000;
+    _count = _next = 0;
+}
+
+void Si4703AF::learn(byte code) {
+    if(code < SI4703_AF_CODE_FIRST || code > SI4703_AF_CODE_LAST ||
+       _count == SI4703_AF_SIZE)
+        return;
+
+    const word frequency = codeFrequency(code);
+    const byte band = _radio.getBand(), space = _radio.getSpacing();
+
+    //Lists carry the tuned frequency too, and may not suit our band plan
+    if(frequency == _home || frequency < Si4703_BandBottom(band) ||
+       frequency > Si4703_BandTop(band) ||
+       (frequency - Si4703_BandBottom(band)) % Si4703_ChannelSpacing(space))
+        return;
+    for(byte i = 0; i < _count; i++)
+        if(_codes[i] == code) return;
+    _codes[_count] = code;
+    _rssi[_count++] = 0;
+}
+
+void Si4703AF::remove(byte index) {
+    _count--;
+    _codes[index] = _codes[_count];
+    _rssi[index] = _rssi[_count];
+    if(_next >= _count) _next = 0;
+}
+
+void Si4703AF::probe(void) {
+    const word frequency = _radio.getFrequency();
+
+    //The application tuned elsewhere, the list is about another station.
+    //Its PI code, if any came in yet, is right.
+    if(frequency != _home) {
+        _home = frequency;
+        _count = _next = 0;
+
+        return;
+    };
+    _homeRSSI = _radio.getStatus() & SI4703_RSSI_MASK;
+    if(!_pi || _homeRSSI >= _threshold) return;
+
+    byte tries = _count;
+
+    //Round the list, past the frequencies carrying another station
+    do {
+        _current = _next;
+        _next = (_next + 1) % _count;
+    } while(_rssi[_current] == SI4703_AF_RSSI_OTHER && --tries);
+    if(!tries) return;
+    _userMuted = _radio.isMuted();
+    if(!_userMuted) _radio.mute();
+    _radio.holdTelemetry(true);
+    if(!_radio.startSetFrequency(codeFrequency(_codes[_current]))) {
+        _radio.holdTelemetry(false);
+        if(!_userMuted) _radio.unMute();
+
+        return;
+    };
+    _probes++;
+    _state = SI4703_AF_PROBING;
+    _step = SI4703AF_STEP_PROBE;
+}
+
+void Si4703AF::goBack(void) {
+    //Someone else is using the radio, try again on the next poll()
+    _step = _radio.startSetFrequency(_home) ? SI4703AF_STEP_RETURN :
+            SI4703AF_STEP_BACK;
+}
+
+void Si4703AF::commit(void) {
+    const word home = _home;
+
+    _home = codeFrequency(_codes[_current]);
+    //The station we left is an alternative of the one we are on now, if it
+    //has an AF code
+    if(home > SI4703_AF_CODE_BASE &&
+       home <= codeFrequency(SI4703_AF_CODE_LAST)) {
+        _codes[_current] = (home - SI4703_AF_CODE_BASE) /
+                           SI4703_AF_CODE_STEP;
+        _rssi[_current] = _homeRSSI;
+    } else
+        remove(_current);
+    _switches++;
+    finish();
+}
+
+void Si4703AF::finish(void) {
+    _radio.holdTelemetry(false);
+    if(!_userMuted) _radio.unMute();
+    _stamp = millis();
+    _step = SI4703AF_STEP_WAIT;
+    _state = _stopping ? SI4703_AF_IDLE : SI4703_AF_LISTENING;
+    _stopping = false;
+}
+
+#endif
@@ -0,0 +1,155 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the include file for the RDS alternative frequency follower.
+ */
+
+#ifndef _SI4703AF_H_INCLUDED
+#define _SI4703AF_H_INCLUDED
+
+#include "Si4703.h"
+
+#if !SI4703_FEATURE_RDS
+# error Si4703AF.h needs SI4703_FEATURE_RDS
+#endif
+
+//How many alternative frequencies are remembered, 2 bytes each. Method A
+//lists go up to 25, the strongest transmitters usually come first.
+#ifndef SI4703_AF_SIZE
+# define SI4703_AF_SIZE 8
+#endif
+
+//getRSSI() of an alternative frequency found carrying another PI code;
+//it is not probed again for as long as the list is kept
+#define SI4703_AF_RSSI_OTHER 0xFF
+
+//Follower states, see Si4703AF::poll()
+#define SI4703_AF_IDLE 0
+#define SI4703_AF_LISTENING 1
+#define SI4703_AF_PROBING 2
+
+//AF codes (IEC 62106): the VHF frequency range and the LF/MF marker
+#define SI4703_AF_CODE_FIRST 1
+#define SI4703_AF_CODE_LAST 204
+#define SI4703_AF_CODE_BASE 8750
+#define SI4703_AF_CODE_STEP 10
+#define SI4703_AF_CODE_LFMF 250
+
+class Si4703AF
+{
+    public:
+        /*
+        * Description:
+        *   Binds the follower to a radio. Nothing happens until start().
+        * Parameters:
+        *   radio - an already begin()-ed Si4703, in interrupt mode or
+        *           refresh()-ed often enough to receive RDS.
+        */
+        Si4703AF(Si4703 &radio);
+
+        /*
+        * Description:
+        *   Starts following the station the radio is tuned to. Whenever its
+        *   RSSI falls below threshold, one alternative frequency is probed
+        *   every interval: the radio is muted, tuned there and, if the
+        *   signal is at least margin stronger, kept there once a group
+        *   carrying the same PI code comes in within piWait. Otherwise the
+        *   radio goes back and is unmuted, about two tune times (120ms)
+        *   later. Nothing happens until poll() is called.
+        * Parameters:
+        *   threshold - in dBuV, see above.
+        *   margin    - in dB, see above.
+        *   interval  - in ms, see above.
+        *   piWait    - in ms, see above. The chip needs a few groups to get
+        *               in sync with a new station.
+        */
+        void start(byte threshold = 30, byte margin = 6,
+                   word interval = 2000, word piWait = 500);
+
+        /*
+        * Description:
+        *   Stops following. A probe under way is finished first, keep
+        *   calling poll() until it returns SI4703_AF_IDLE.
+        */
+        void stop(void);
+
+        /*
+        * Description:
+        *   Feeds the follower an RDS group: PI codes and AF lists are
+        *   learned from the groups the application reads, so pass it every
+        *   one of them. While probing, poll() reads the groups itself, so
+        *   leave the ring alone then:
+        *   if(follower.poll() != SI4703_AF_PROBING)
+        *     while(radio.readRDSGroup(block, stamp, errors)) {
+        *       follower.process(block, errors);
+        *       RDSDecoder::decodeRDSGroup(block);
+        *     }
+        *   Groups are learned from before start() too. A new PI code means a
+        *   new station and empties the list.
+        * Parameters:
+        *   errors - the block error levels from readRDSGroup(), blocks with
+        *            errors are not learned from.
+        */
+        void process(const word *block, byte errors = 0);
+
+        /*
+        * Description:
+        *   Advances the follower one step at a time and never blocks, call
+        *   it from loop(). While probing it owns the radio and reads the RDS
+        *   groups itself.
+        * Returns:
+        *   one of the SI4703_AF_* states.
+        */
+        byte poll(void);
+
+        byte getState(void) { return _state; };
+        word getPI(void) { return _pi; };
+        byte getCount(void) { return _count; };
+
+        /*
+        * Description:
+        *   The alternative frequencies learned so far, in 10kHz units, and
+        *   the RSSI each had when last probed (0 if never,
+        *   SI4703_AF_RSSI_OTHER if another station was found there).
+        */
+        word getFrequency(byte index) { return codeFrequency(_codes[index]); };
+        byte getRSSI(byte index) { return _rssi[index]; };
+
+        /*
+        * Description:
+        *   Instrumentation counters: probes made and how many of them ended
+        *   with the radio staying on the alternative frequency.
+        */
+        unsigned long getProbes(void) { return _probes; };
+        unsigned long getSwitches(void) { return _switches; };
+
+    private:
+        Si4703 &_radio;
+        byte _codes[SI4703_AF_SIZE], _rssi[SI4703_AF_SIZE];
+        byte _count, _next, _current;
+        byte _state, _step;
+        bool _stopping, _userMuted;
+        byte _threshold, _margin, _homeRSSI;
+        word _interval, _piWait;
+        word _home, _pi;
+        unsigned long _stamp, _probes, _switches;
+
+        static word codeFrequency(byte code) {
+            return SI4703_AF_CODE_BASE + code * SI4703_AF_CODE_STEP; };
+
+        void forget(void);
+        void learn(byte code);
+        void remove(byte index);
+        void probe(void);
+        void goBack(void);
+        void commit(void);
+        void finish(void);
+};
+
+#endif
@@ -0,0 +1,45 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This file enables interrupt mode with GPIO2 on any pin that has a pin change
+ * interrupt (all of them on the Uno), not just on the external interrupt
+ * pins. Include it from your sketch, and from one file only: it defines the
+ * PCINTn_vect handlers, which is why the library does not do so on its own.
+ * That also means it cannot be used together with anything else that
+ * defines them, SoftwareSerial being the usual suspect.
+ */
+
+#ifndef _SI4703PCINT_H_INCLUDED
+#define _SI4703PCINT_H_INCLUDED
+
+#include "Si4703.h"
+
+#if !SI4703_FEATURE_INTERRUPTS
+# error Si4703PCINT.h needs SI4703_FEATURE_INTERRUPTS
+#endif
+
+#include <avr/interrupt.h>
+
+#ifdef PCINT0_vect
+ISR(PCINT0_vect) { Si4703::dispatchPinChange(0); }
+#endif
+#ifdef PCINT1_vect
+ISR(PCINT1_vect) { Si4703::dispatchPinChange(1); }
+#endif
+#ifdef PCINT2_vect
+ISR(PCINT2_vect) { Si4703::dispatchPinChange(2); }
+#endif
+#ifdef PCINT3_vect
+ISR(PCINT3_vect) { Si4703::dispatchPinChange(3); }
+#endif
+
+//Tells the library the above are in place, before setup() runs
+static const bool Si4703_PinChangeEnabled = Si4703::enablePinChange();
+
+#endif
@@ -0,0 +1,160 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the code file for the EEPROM-backed preset store.
+ * See the header file for better function documentation.
+ */
+
+#include "Si4703Presets.h"
+
+#include <string.h>
+
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+Si4703Presets::Si4703Presets(Si4703 &radio) : _radio(radio) {
+    memset(&_record, 0x00, sizeof(_record));
+    _record.version = SI4703_PRESETS_VERSION;
+    //So that the first save() goes to slot 0
+    _slot = SI4703_PRESETS_SLOTS - 1;
+    _dirty = false;
+}
+
+bool Si4703Presets::begin(byte band, bool xosc, byte interrupt) {
+    _radio.begin(band, xosc, interrupt);
+    load();
+
+    return _record.flags & SI4703_PRESETS_FLG_RESTORE &&
+           recall(SI4703_PRESET_LAST);
+}
+
+bool Si4703Presets::load(void) {
+    Si4703_PresetRecord record;
+    bool found = false;
+
+    for(byte slot = 0; slot < SI4703_PRESETS_SLOTS; slot++) {
+        eeprom_read_block(&record, slotAddress(slot), sizeof(record));
+        if(record.version != SI4703_PRESETS_VERSION ||
+           record.crc != crc(record))
+            continue;
+        //Sequence numbers wrap around, compare them serial number style
+        if(!found || (signed char)(record.sequence - _record.sequence) > 0) {
+            memcpy(&_record, &record, sizeof(_record));
+            _slot = slot;
+            found = true;
+        };
+    };
+    if(!found) {
+        memset(&_record, 0x00, sizeof(_record));
+        _record.version = SI4703_PRESETS_VERSION;
+        _slot = SI4703_PRESETS_SLOTS - 1;
+    };
+    _dirty = false;
+
+    return found;
+}
+
+bool Si4703Presets::save(void) {
+    if(!_dirty) return false;
+
+    //Never overwrite the newest good copy, a power loss halfway through
+    //would leave us with none
+    _slot = (_slot + 1) % SI4703_PRESETS_SLOTS;
+    _record.sequence++;
+    _record.crc = crc(_record);
+    eeprom_update_block(&_record, slotAddress(_slot), sizeof(_record));
+    _dirty = false;
+
+    return true;
+}
+
+void Si4703Presets::store(byte index) {
+    Si4703_Preset preset;
+
+    preset.tuning = SI4703_PRESET_VALID |
+                    _radio.getBand() << SI4703_PRESET_BAND_SHIFT |
+                    _radio.getSpacing() << SI4703_PRESET_SPACE_SHIFT |
+                    (_radio._registers[SI4703_REG_READCHAN] &
+                     SI4703_READCHAN_MASK);
+    preset.volume = _radio._registers[SI4703_REG_SYSCONFIG2] &
+                    SI4703_VOLUME_MASK;
+    if(_radio._registers[SI4703_REG_SYSCONFIG3] & SI4703_FLG_VOLEXT)
+        preset.volume |= SI4703_PRESET_VOLEXT;
+    preset.rssi = _radio.getStatus() & SI4703_RSSI_MASK;
+
+    if(memcmp(&preset, &_record.presets[index], sizeof(preset))) {
+        memcpy(&_record.presets[index], &preset, sizeof(preset));
+        _dirty = true;
+    };
+}
+
+void Si4703Presets::clear(byte index) {
+    if(!isValid(index)) return;
+
+    memset(&_record.presets[index], 0x00, sizeof(_record.presets[index]));
+    _dirty = true;
+}
+
+bool Si4703Presets::recall(byte index, bool async) {
+    const Si4703_Preset &preset = _record.presets[index];
+    const byte band = (preset.tuning >> SI4703_PRESET_BAND_SHIFT) &
+                      SI4703_BAND_MASK;
+    const byte space = (preset.tuning >> SI4703_PRESET_SPACE_SHIFT) &
+                       SI4703_SPACE_MASK;
+
+    if(!isValid(index) || !_radio.isReady() ||
+       _radio.getTuneState() == SI4703_TUNE_BUSY)
+        return false;
+
+    //Only touch the shadow here, the tune below writes it all out at once
+    _radio.clearFlags(SI4703_REG_SYSCONFIG2, SI4703_BAND_MASK |
+                      SI4703_SPACE_MASK | SI4703_VOLUME_MASK);
+    _radio.setFlags(SI4703_REG_SYSCONFIG2, band | space |
+                    (preset.volume & SI4703_PRESET_VOLUME_MASK));
+    if(preset.volume & SI4703_PRESET_VOLEXT)
+        _radio.setFlags(SI4703_REG_SYSCONFIG3, SI4703_FLG_VOLEXT);
+    else
+        _radio.clearFlags(SI4703_REG_SYSCONFIG3, SI4703_FLG_VOLEXT);
+
+    return async ?
+        _radio.startSetFrequency(Si4703_ChannelToFrequency(
+            preset.tuning & SI4703_PRESET_CHANNEL_MASK, band, space)) :
+        _radio.setFrequency(Si4703_ChannelToFrequency(
+            preset.tuning & SI4703_PRESET_CHANNEL_MASK, band, space));
+}
+
+bool Si4703Presets::update(void) {
+    store(SI4703_PRESET_LAST);
+
+    return save();
+}
+
+void Si4703Presets::setRestoreOnBegin(bool restore) {
+    const byte flags = restore ? _record.flags | SI4703_PRESETS_FLG_RESTORE :
+                                 _record.flags & ~SI4703_PRESETS_FLG_RESTORE;
+
+    if(flags != _record.flags) {
+        _record.flags = flags;
+        _dirty = true;
+    };
+}
+
+byte Si4703Presets::crc(const Si4703_PresetRecord &record) {
+    byte crc = 0x00;
+
+    for(byte i = 0; i < offsetof(Si4703_PresetRecord, crc); i++)
+        crc = _crc8_ccitt_update(crc, ((const byte *)&record)[i]);
+
+    return crc;
+}
+
+Si4703_PresetRecord *Si4703Presets::slotAddress(byte slot) {
+    return (Si4703_PresetRecord *)(SI4703_PRESETS_ADDRESS +
+                                   slot * sizeof(Si4703_PresetRecord));
+}
@@ -0,0 +1,158 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the include file for the EEPROM-backed preset store.
+ */
+
+#ifndef _SI4703PRESETS_H_INCLUDED
+#define _SI4703PRESETS_H_INCLUDED
+
+#include "Si4703.h"
+
+//Define any of these in Si4703-config.h to change the EEPROM
+//layout: SI4703_PRESETS_SLOTS copies of the record are written in turn to
+//spread wear, starting at SI4703_PRESETS_ADDRESS.
+#ifndef SI4703_PRESETS_COUNT
+# define SI4703_PRESETS_COUNT 6
+#endif
+#ifndef SI4703_PRESETS_SLOTS
+# define SI4703_PRESETS_SLOTS 4
+#endif
+#ifndef SI4703_PRESETS_ADDRESS
+# define SI4703_PRESETS_ADDRESS 0
+#endif
+
+//Bump whenever Si4703_PresetRecord changes
+#define SI4703_PRESETS_VERSION 1
+
+//Preset index holding the last state, see Si4703Presets::update()
+#define SI4703_PRESET_LAST SI4703_PRESETS_COUNT
+
+//Preset fields
+#define SI4703_PRESET_VALID 0x8000
+#define SI4703_PRESET_BAND_SHIFT 6
+#define SI4703_PRESET_SPACE_SHIFT 6
+#define SI4703_PRESET_CHANNEL_MASK 0x03FF
+#define SI4703_PRESET_VOLUME_MASK 0x0F
+#define SI4703_PRESET_VOLEXT 0x10
+
+//Record flags
+#define SI4703_PRESETS_FLG_RESTORE 0x01
+
+/*
+* Description:
+*   One preset, 4 bytes.
+*   tuning - SI4703_PRESET_VALID | band << 6 | space << 6 | channel, where
+*            band and space are the SI4703_BAND_* and SI4703_SPACE_* field
+*            values (already shifted in SYSCONFIG2, so they land on bits
+*            13:12 and 11:10 respectively).
+*   volume - VOLUME field, ORed with SI4703_PRESET_VOLEXT if it was set.
+*   rssi   - in dBuV, when the preset was stored.
+*/
+typedef struct {
+    word tuning;
+    byte volume;
+    byte rssi;
+} Si4703_Preset;
+
+/*
+* Description:
+*   What goes into each EEPROM slot.
+*   sequence - incremented on every save, the newest valid slot wins.
+*   crc      - CRC-8 of everything before it.
+*/
+typedef struct {
+    byte version;
+    byte sequence;
+    byte flags;
+    Si4703_Preset presets[SI4703_PRESETS_COUNT + 1];
+    byte crc;
+} Si4703_PresetRecord;
+
+class Si4703Presets
+{
+    public:
+        Si4703Presets(Si4703 &radio);
+
+        /*
+        * Description:
+        *   Brings the radio up with begin() (see there for parameters),
+        *   loads the presets and, if setRestoreOnBegin() was enabled when
+        *   they were saved, goes back to the last station and volume with a
+        *   single direct tune.
+        * Returns:
+        *   true if the last state was restored.
+        */
+        bool begin(byte band, bool xosc = true,
+                   byte interrupt = SI4703_INT_DIRECT);
+
+        /*
+        * Description:
+        *   Loads the newest valid record from EEPROM. If there is none (first
+        *   use, layout change, corruption) all presets start out empty.
+        * Returns:
+        *   true if a valid record was found.
+        */
+        bool load(void);
+
+        /*
+        * Description:
+        *   Writes the presets to the next EEPROM slot, but only if they
+        *   changed since the last load() or save(); only the bytes that
+        *   differ from what the slot already holds get programmed.
+        * Returns:
+        *   true if anything was written.
+        */
+        bool save(void);
+
+        /*
+        * Description:
+        *   Captures the current channel, band, spacing, volume and RSSI into
+        *   preset index (SI4703_PRESET_LAST for the last state), or empties
+        *   it. No bus traffic: everything comes from the register shadow as
+        *   of the last completed tune.
+        */
+        void store(byte index);
+        void clear(byte index);
+        bool isValid(byte index) {
+            return _record.presets[index].tuning & SI4703_PRESET_VALID; };
+        const Si4703_Preset &getPreset(byte index) {
+            return _record.presets[index]; };
+
+        /*
+        * Description:
+        *   Goes to preset index with a direct tune, switching band, spacing
+        *   and volume first if they differ.
+        * Parameters:
+        *   async - just start the tune and leave it to Si4703::poll().
+        * Returns:
+        *   false if the preset is empty or the radio is busy.
+        */
+        bool recall(byte index, bool async = false);
+
+        /*
+        * Description:
+        *   Stores the last state and saves, e.g. on a timer or before going
+        *   to sleep; cheap when nothing changed.
+        */
+        bool update(void);
+
+        void setRestoreOnBegin(bool restore);
+
+    private:
+        Si4703 &_radio;
+        Si4703_PresetRecord _record;
+        byte _slot;
+        bool _dirty;
+
+        static byte crc(const Si4703_PresetRecord &record);
+        static Si4703_PresetRecord *slotAddress(byte slot);
+};
+
+#endif
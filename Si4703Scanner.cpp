@@ -0,0 +1,173 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the code file for the band scanner.
+ * See the header file for better function documentation.
+ */
+
+#include "Si4703Scanner.h"
+
+//What poll() is waiting for
+#define SI4703SCANNER_STEP_TUNE 0
+#define SI4703SCANNER_STEP_SEEK 1
+#define SI4703SCANNER_STEP_RDS 2
+#define SI4703SCANNER_STEP_NEXT 3
+
+Si4703Scanner::Si4703Scanner(Si4703 &radio, Si4703_Station *table, byte size)
+    : _radio(radio) {
+    _table = table;
+    _size = size;
+    _count = _limit = 0;
+    _state = SI4703_SCAN_IDLE;
+}
+
+bool Si4703Scanner::start(byte method, byte minRSSI, byte limit,
+                          word piWait) {
+    _band = _radio.getBand();
+    _space = _radio.getSpacing();
+    if(!_size || !_radio.startSetFrequency(Si4703_BandBottom(_band)))
+        return false;
+
+    _method = method;
+    _minRSSI = minRSSI;
+    _limit = limit && limit < _size ? limit : _size;
+    _piWait = piWait;
+    _count = 0;
+    _channel = 0;
+    _step = SI4703SCANNER_STEP_TUNE;
+    _state = SI4703_SCAN_BUSY;
+
+    return true;
+}
+
+byte Si4703Scanner::poll(void) {
+    if(_state != SI4703_SCAN_BUSY) return _state;
+
+    switch(_step) {
+        case SI4703SCANNER_STEP_TUNE:
+        case SI4703SCANNER_STEP_SEEK: {
+            const byte tune = _radio.poll();
+
+            if(tune == SI4703_TUNE_BUSY) break;
+            //The chip stops at the band limit when a seek finds nothing
+            if(_step == SI4703SCANNER_STEP_SEEK &&
+               tune == SI4703_TUNE_FAILED) {
+                finish();
+                break;
+            };
+
+            const word status = _radio.getStatus();
+
+            _channel = Si4703_FrequencyToChannel(_radio.getTuneFrequency(),
+                                                 _band, _space);
+            //A seek only stops on valid channels, a tune needs judging
+            if(_step == SI4703SCANNER_STEP_TUNE &&
+               ((status & SI4703_RSSI_MASK) < _minRSSI ||
+                status & SI4703_STATUS_AFCRL)) {
+                next();
+                break;
+            };
+            record();
+#if SI4703_FEATURE_RDS
+            if(_piWait) {
+                _stamp = millis();
+                _step = SI4703SCANNER_STEP_RDS;
+            } else
+#endif
+                next();
+            break;
+        };
+#if SI4703_FEATURE_RDS
+        case SI4703SCANNER_STEP_RDS: {
+            word block[4];
+            Si4703_Station &station = _table[_count - 1];
+
+            //The ring was flushed on tuning, all of this is from here
+            while(!station.pi && _radio.readRDSGroup(block))
+                station.pi = block[0];
+            if(station.pi || millis() - _stamp >= _piWait) next();
+            break;
+        };
+#endif
+        case SI4703SCANNER_STEP_NEXT:
+            next();
+            break;
+    };
+
+    return _state;
+}
+
+void Si4703Scanner::stop(void) {
+    if(_state == SI4703_SCAN_BUSY) _state = SI4703_SCAN_IDLE;
+}
+
+bool Si4703Scanner::resume(void) {
+    //Nothing to resume before start() or once the band has been walked
+    if(_state != SI4703_SCAN_IDLE || !_limit) return false;
+    _state = SI4703_SCAN_BUSY;
+
+    return true;
+}
+
+word Si4703Scanner::getFrequency(byte index) {
+    return Si4703_ChannelToFrequency(
+        _table[index].channel & SI4703_STATION_CHANNEL_MASK, _band, _space);
+}
+
+void Si4703Scanner::sort(byte key) {
+    for(byte i = 1; i < _count; i++) {
+        const Si4703_Station station = _table[i];
+        byte j = i;
+
+        while(j && (key == SI4703_SORT_RSSI ?
+                    _table[j - 1].rssi < station.rssi :
+                    (_table[j - 1].channel & SI4703_STATION_CHANNEL_MASK) >
+                    (station.channel & SI4703_STATION_CHANNEL_MASK))) {
+            _table[j] = _table[j - 1];
+            j--;
+        };
+        _table[j] = station;
+    };
+}
+
+void Si4703Scanner::next(void) {
+    bool started;
+
+    if(_count == _limit ||
+       _channel >= Si4703_FrequencyToChannel(Si4703_BandTop(_band), _band,
+                                             _space)) {
+        finish();
+        return;
+    };
+    if(_method == SI4703_SCAN_SEEK) {
+        started = _radio.startSeekUp(false);
+        _step = SI4703SCANNER_STEP_SEEK;
+    } else {
+        started = _radio.startSetFrequency(
+            Si4703_ChannelToFrequency(_channel + 1, _band, _space));
+        _step = SI4703SCANNER_STEP_TUNE;
+    };
+    //Someone else is using the radio, try again on the next poll()
+    if(!started) _step = SI4703SCANNER_STEP_NEXT;
+}
+
+void Si4703Scanner::record(void) {
+    const word status = _radio.getStatus();
+    Si4703_Station &station = _table[_count++];
+
+    station.channel = _channel;
+    if(status & SI4703_STATUS_ST) station.channel |= SI4703_STATION_STEREO;
+    if(status & SI4703_STATUS_AFCRL) station.channel |= SI4703_STATION_AFCRL;
+    station.rssi = status & SI4703_RSSI_MASK;
+    station.pi = 0x0000;
+}
+
+void Si4703Scanner::finish(void) {
+    _state = SI4703_SCAN_DONE;
+}
@@ -0,0 +1,137 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the include file for the band scanner.
+ */
+
+#ifndef _SI4703SCANNER_H_INCLUDED
+#define _SI4703SCANNER_H_INCLUDED
+
+#include "Si4703.h"
+
+//Scanner states, see Si4703Scanner::poll()
+#define SI4703_SCAN_IDLE 0
+#define SI4703_SCAN_BUSY 1
+#define SI4703_SCAN_DONE 2
+
+//Scan methods, see Si4703Scanner::start()
+#define SI4703_SCAN_SEEK 0
+#define SI4703_SCAN_TUNE 1
+
+//Sort keys, see Si4703Scanner::sort()
+#define SI4703_SORT_CHANNEL 0
+#define SI4703_SORT_RSSI 1
+
+//Station table entry flags, packed above the channel number
+#define SI4703_STATION_CHANNEL_MASK 0x03FF
+#define SI4703_STATION_AFCRL 0x4000
+#define SI4703_STATION_STEREO 0x8000
+
+/*
+* Description:
+*   One entry in the station table, 5 bytes on the AVR.
+*   channel - channel number in the band and spacing the scan ran with, ORed
+*             with the SI4703_STATION_* flags.
+*   rssi    - in dBuV, as seen when the chip settled on the channel.
+*   pi      - RDS Program Identification code, zero if none was heard.
+*/
+typedef struct {
+    word channel;
+    byte rssi;
+    word pi;
+} Si4703_Station;
+
+class Si4703Scanner
+{
+    public:
+        /*
+        * Description:
+        *   Binds the scanner to a radio and to a caller-provided station
+        *   table, which bounds memory use: the scanner never allocates.
+        * Parameters:
+        *   radio - an already begin()-ed Si4703.
+        *   table - storage for up to size stations.
+        */
+        Si4703Scanner(Si4703 &radio, Si4703_Station *table, byte size);
+
+        /*
+        * Description:
+        *   Empties the table and starts walking the band from the bottom.
+        *   Nothing happens until poll() is called.
+        * Parameters:
+        *   method   - SI4703_SCAN_SEEK lets the chip find valid channels
+        *              according to its seek thresholds, SI4703_SCAN_TUNE
+        *              visits every channel and keeps those at or above
+        *              minRSSI. Either way the bottom channel is tuned to and
+        *              judged by minRSSI, as seeking starts past it.
+        *   minRSSI  - see above, in dBuV.
+        *   limit    - stop once this many stations have been found, 0 for as
+        *              many as the table holds.
+        *   piWait   - how long to listen for RDS on each station, in ms, to
+        *              fill in its PI code. Needs interrupt mode and
+        *              SI4703_FEATURE_RDS; 0 to skip.
+        * Returns:
+        *   false without side-effects if the radio is busy.
+        */
+        bool start(byte method = SI4703_SCAN_SEEK, byte minRSSI = 20,
+                   byte limit = 0, word piWait = 0);
+
+        /*
+        * Description:
+        *   Advances the scan one step at a time and never blocks, call it
+        *   from loop(). A scan that was stop()-ed does not advance.
+        * Returns:
+        *   one of the SI4703_SCAN_* states.
+        */
+        byte poll(void);
+
+        /*
+        * Description:
+        *   stop() pauses the scan after the operation in progress, resume()
+        *   picks it up from the next channel. The table is kept.
+        */
+        void stop(void);
+        bool resume(void);
+
+        byte getState(void) { return _state; };
+        byte getCount(void) { return _count; };
+        const Si4703_Station &getStation(byte index) { return _table[index]; };
+
+        /*
+        * Description:
+        *   Converts the channel of a table entry back to a frequency, in
+        *   10kHz units.
+        */
+        word getFrequency(byte index);
+
+        /*
+        * Description:
+        *   Sorts the table in place: by ascending channel (the order a scan
+        *   fills it in, so usually free) or by descending RSSI. Insertion
+        *   sort, as tables are small and mostly ordered already.
+        * Parameters:
+        *   key - one of the SI4703_SORT_* constants.
+        */
+        void sort(byte key);
+
+    private:
+        Si4703 &_radio;
+        Si4703_Station *_table;
+        byte _size, _count, _limit;
+        byte _state, _step, _method, _minRSSI;
+        byte _band, _space;
+        word _channel, _piWait;
+        unsigned long _stamp;
+
+        void next(void);
+        void record(void);
+        void finish(void);
+};
+
+#endif
@@ -0,0 +1,52 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the code file for the multi-tuner scheduler.
+ * See the header file for better function documentation.
+ */
+
+#include "Si4703Scheduler.h"
+
+Si4703Scheduler::Si4703Scheduler(word interval) {
+    _count = _next = 0;
+    _interval = interval;
+    _worst = 0;
+}
+
+bool Si4703Scheduler::add(Si4703 &radio) {
+    if(_count == SI4703_SCHEDULER_SIZE) return false;
+
+    _radios[_count] = &radio;
+    _visited[_count] = _refreshed[_count] = micros();
+    _count++;
+
+    return true;
+}
+
+byte Si4703Scheduler::run(void) {
+    if(!_count) return SI4703_SCHEDULER_NONE;
+
+    const byte index = _next;
+    Si4703 &radio = *_radios[index];
+    const unsigned long now = micros();
+
+    _next = (_next + 1) % _count;
+    _worst = max(_worst, now - _visited[index]);
+    _visited[index] = now;
+
+    radio.poll();
+    //Interrupt mode radios fetch RDS on their own
+    if(radio.isReady() && radio.getInterruptMode() == SI4703_INT_NONE &&
+       now - _refreshed[index] >= _interval * 1000UL) {
+        radio.refresh();
+        _refreshed[index] = now;
+    };
+
+    return index;
+}
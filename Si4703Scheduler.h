@@ -0,0 +1,84 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the include file for the multi-tuner scheduler.
+ */
+
+#ifndef _SI4703SCHEDULER_H_INCLUDED
+#define _SI4703SCHEDULER_H_INCLUDED
+
+#include "Si4703.h"
+
+//How many radios a scheduler can juggle
+#ifndef SI4703_SCHEDULER_SIZE
+# define SI4703_SCHEDULER_SIZE 4
+#endif
+
+//Default pause between two status/RDS reads of a polled radio, in ms. Just
+//under the 40ms RDSR stays up for, so that no group goes unnoticed.
+#define SI4703_SCHEDULER_INTERVAL 35
+
+//Returned by run() when there is nothing to schedule
+#define SI4703_SCHEDULER_NONE 0xFF
+
+class Si4703Scheduler
+{
+    public:
+        /*
+        * Description:
+        *   Creates an empty scheduler.
+        * Parameters:
+        *   interval - see SI4703_SCHEDULER_INTERVAL.
+        */
+        Si4703Scheduler(word interval = SI4703_SCHEDULER_INTERVAL);
+
+        /*
+        * Description:
+        *   Adds a radio to the rotation; begin() or startBegin() it before or
+        *   after, run() takes care of the rest either way.
+        * Returns:
+        *   false if the scheduler is full.
+        */
+        bool add(Si4703 &radio);
+
+        /*
+        * Description:
+        *   Gives the next radio in turn its share of attention: poll() (which
+        *   advances power-up and seek/tune and, in deferred interrupt mode,
+        *   services the interrupt) and, in polling mode and once every
+        *   interval, a status/RDS refresh(). Every call visits exactly one
+        *   radio, so with N radios each is looked at every N calls and a
+        *   call costs at most one radio's worth of bus traffic. Call it from
+        *   loop().
+        * Returns:
+        *   the index of the radio visited, SI4703_SCHEDULER_NONE if empty.
+        */
+        byte run(void);
+
+        byte getCount(void) { return _count; };
+        Si4703 &getRadio(byte index) { return *_radios[index]; };
+
+        /*
+        * Description:
+        *   Instrumentation: the longest time, in microseconds, any radio had
+        *   to wait between two visits. Divide by the number of radios to see
+        *   how long loop() takes.
+        */
+        unsigned long getWorstLatency(void) { return _worst; };
+
+    private:
+        Si4703 *_radios[SI4703_SCHEDULER_SIZE];
+        unsigned long _visited[SI4703_SCHEDULER_SIZE];
+        unsigned long _refreshed[SI4703_SCHEDULER_SIZE];
+        byte _count, _next;
+        word _interval;
+        unsigned long _worst;
+};
+
+#endif
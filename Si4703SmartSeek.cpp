@@ -0,0 +1,200 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the code file for the smart seek.
+ * See the header file for better function documentation.
+ */
+
+#include "Si4703SmartSeek.h"
+
+//What poll() is waiting for
+#define SI4703SMARTSEEK_STEP_SEEK 0
+#define SI4703SMARTSEEK_STEP_DWELL 1
+#define SI4703SMARTSEEK_STEP_NEXT 2
+#define SI4703SMARTSEEK_STEP_BACK 3
+#define SI4703SMARTSEEK_STEP_RETURN 4
+
+Si4703SmartSeek::Si4703SmartSeek(Si4703 &radio) : _radio(radio) {
+    setDwell(300, 6, SI4703_SMARTSEEK_STEREO | SI4703_SMARTSEEK_RDS);
+    //What begin() sets
+    setThresholds(0, 1, 1);
+    _state = SI4703_TUNE_IDLE;
+    _floor = 0;
+    _rejected = 0;
+}
+
+void Si4703SmartSeek::setDwell(word dwell, byte margin, byte criteria) {
+    _dwell = dwell;
+    _margin = margin;
+    _criteria = criteria;
+}
+
+void Si4703SmartSeek::setThresholds(byte rssi, byte snr, byte count) {
+    _baseRSSI = rssi;
+    _baseSNR = snr;
+    _baseCount = count;
+}
+
+bool Si4703SmartSeek::start(bool up, bool wrap) {
+    if(!_radio.isReady() || _radio.getTuneState() == SI4703_TUNE_BUSY)
+        return false;
+
+    _up = up;
+    _wrap = wrap;
+    _streak = 0;
+    _start = _last = _radio.getFrequency();
+    _state = SI4703_TUNE_BUSY;
+    seek();
+
+    return true;
+}
+
+byte Si4703SmartSeek::poll(void) {
+    if(_state != SI4703_TUNE_BUSY) return _state;
+
+    switch(_step) {
+        case SI4703SMARTSEEK_STEP_SEEK: {
+            const byte tune = _radio.poll();
+
+            if(tune == SI4703_TUNE_BUSY) break;
+            //Nothing at all passed the chip's own thresholds
+            if(tune == SI4703_TUNE_FAILED) {
+                if(_wrap) _floor /= 2;
+                finish(SI4703_TUNE_FAILED);
+                break;
+            };
+
+            const word frequency = _radio.getTuneFrequency();
+
+            if(passed(frequency)) {
+                //Been all the way around, nothing was worth keeping
+                _floor /= 2;
+                goBack();
+                break;
+            };
+            _last = frequency;
+            _rssiSum = 0;
+            _samples = _stereo = _rds = _afcrl = 0;
+            _stamp = millis();
+            _sampled = _stamp - SI4703_SMARTSEEK_SAMPLE_INTERVAL;
+            _step = SI4703SMARTSEEK_STEP_DWELL;
+            break;
+        };
+        case SI4703SMARTSEEK_STEP_DWELL:
+            if(millis() - _sampled >= SI4703_SMARTSEEK_SAMPLE_INTERVAL)
+                sample();
+            break;
+        //Someone else is using the radio, try again
+        case SI4703SMARTSEEK_STEP_NEXT:
+            seek();
+            break;
+        case SI4703SMARTSEEK_STEP_BACK:
+            goBack();
+            break;
+        case SI4703SMARTSEEK_STEP_RETURN:
+            if(_radio.poll() != SI4703_TUNE_BUSY)
+                finish(SI4703_TUNE_FAILED);
+            break;
+    };
+
+    return _state;
+}
+
+byte Si4703SmartSeek::seekUp(bool wrap) {
+    if(!start(true, wrap)) return SI4703_TUNE_FAILED;
+    while(poll() == SI4703_TUNE_BUSY) yield();
+
+    return _state;
+}
+
+byte Si4703SmartSeek::seekDown(bool wrap) {
+    if(!start(false, wrap)) return SI4703_TUNE_FAILED;
+    while(poll() == SI4703_TUNE_BUSY) yield();
+
+    return _state;
+}
+
+bool Si4703SmartSeek::seek(void) {
+    const byte rssi = min(max(_floor, _baseRSSI),
+                          (byte)SI4703_SMARTSEEK_SEEKTH_MAX);
+
+    //The thresholds go out with the write that starts the seek
+    _radio.beginTransaction();
+    _radio.setSeekThresholds(rssi, min(_baseSNR + _streak, 15),
+                             min(_baseCount + _streak, 15));
+    if(!(_up ? _radio.startSeekUp(_wrap) : _radio.startSeekDown(_wrap))) {
+        _radio.commitTransaction();
+        _step = SI4703SMARTSEEK_STEP_NEXT;
+
+        return false;
+    };
+    _radio.commitTransaction();
+    _step = SI4703SMARTSEEK_STEP_SEEK;
+
+    return true;
+}
+
+void Si4703SmartSeek::goBack(void) {
+    _step = _radio.startSetFrequency(_start) ? SI4703SMARTSEEK_STEP_RETURN :
+            SI4703SMARTSEEK_STEP_BACK;
+}
+
+bool Si4703SmartSeek::passed(word frequency) {
+    if(!_wrap) return false;
+
+    //Stops go one way round the band, the start is passed when it falls
+    //between the last stop and this one
+    if(_up)
+        return frequency > _last ? _last < _start && _start <= frequency :
+               _start > _last || _start <= frequency;
+    else
+        return frequency < _last ? frequency <= _start && _start < _last :
+               _start < _last || _start >= frequency;
+}
+
+void Si4703SmartSeek::sample(void) {
+    const byte rssi = _radio.getRSSI();
+    const word status = _radio.getStatus();
+
+    _sampled = millis();
+    _rssiSum += rssi;
+    _samples++;
+    if(status & SI4703_STATUS_ST) _stereo++;
+    if(status & SI4703_STATUS_RDSS) _rds++;
+    if(status & SI4703_STATUS_AFCRL) _afcrl++;
+
+    const bool strong = _rssiSum / _samples >= _floor + _margin;
+    const bool alive = !_criteria ||
+        (_criteria & SI4703_SMARTSEEK_STEREO && _stereo) ||
+        (_criteria & SI4703_SMARTSEEK_RDS && _rds);
+
+    //One sample could be a fade, wait for a second one either way
+    if(_samples < 2) return;
+    if(2 * _afcrl > _samples) reject();
+    else if(strong && alive) {
+        _streak = 0;
+        finish(SI4703_TUNE_COMPLETE);
+    } else if(millis() - _stamp >= _dwell)
+        reject();
+}
+
+void Si4703SmartSeek::reject(void) {
+    const byte rssi = _rssiSum / _samples;
+
+    _floor = _floor ? (3 * _floor + rssi) / 4 : rssi;
+    _rejected++;
+    _streak++;
+    seek();
+}
+
+void Si4703SmartSeek::finish(byte state) {
+    //Leave the chip's own seekUp()/seekDown() as the application set them
+    _radio.setSeekThresholds(_baseRSSI, _baseSNR, _baseCount);
+    _state = state;
+}
@@ -0,0 +1,136 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the include file for the smart seek.
+ */
+
+#ifndef _SI4703SMARTSEEK_H_INCLUDED
+#define _SI4703SMARTSEEK_H_INCLUDED
+
+#include "Si4703.h"
+
+//Signs of a real station a stop must show, see Si4703SmartSeek::setDwell()
+#define SI4703_SMARTSEEK_STEREO 0x01
+#define SI4703_SMARTSEEK_RDS 0x02
+
+//Pause between two status samples while dwelling, in ms
+#define SI4703_SMARTSEEK_SAMPLE_INTERVAL 25
+
+//Highest SEEKTH the noise floor may push the chip to, in dBuV
+#define SI4703_SMARTSEEK_SEEKTH_MAX 45
+
+class Si4703SmartSeek
+{
+    public:
+        /*
+        * Description:
+        *   Binds the seek to a radio. The noise floor starts out unknown.
+        * Parameters:
+        *   radio - an already begin()-ed Si4703.
+        */
+        Si4703SmartSeek(Si4703 &radio);
+
+        /*
+        * Description:
+        *   Sets how a stop is judged. After the chip stops, its status is
+        *   sampled for up to dwell ms; the stop is kept as soon as the
+        *   average RSSI is at least margin above the noise floor and, if
+        *   criteria asks for any, one of the SI4703_SMARTSEEK_* signs was
+        *   seen, and given up as soon as the AFC rails in most samples.
+        *   RDS takes the chip a few hundred ms to sync to, stereo shows up
+        *   right away. Defaults to 300ms, 6dB and
+        *   SI4703_SMARTSEEK_STEREO | SI4703_SMARTSEEK_RDS: mono stations
+        *   without RDS are skipped.
+        */
+        void setDwell(word dwell, byte margin, byte criteria);
+
+        /*
+        * Description:
+        *   The least strict seek thresholds used, see
+        *   Si4703::setSeekThresholds(). The chip is given SEEKTH no lower
+        *   than the noise floor and SKSNR/SKCNT one step stricter for each
+        *   false stop of the seek under way, and given these back once it
+        *   is over. Defaults to what begin() sets.
+        */
+        void setThresholds(byte rssi, byte snr, byte count);
+
+        /*
+        * Description:
+        *   Starts seeking, nothing happens until poll() is called.
+        * Parameters:
+        *   up   - direction.
+        *   wrap - carry on from the other end of the band. A seek that
+        *          comes back to where it started without a stop worth
+        *          keeping fails and tunes back there.
+        * Returns:
+        *   false without side-effects if the radio is busy.
+        */
+        bool start(bool up, bool wrap = true);
+
+        /*
+        * Description:
+        *   Advances the seek one step at a time and never blocks, call it
+        *   from loop().
+        * Returns:
+        *   one of the SI4703_TUNE_* states; the frequency it ended on is
+        *   then Si4703::getTuneFrequency().
+        */
+        byte poll(void);
+
+        /*
+        * Description:
+        *   Blocking versions of start() and poll(), for use in place of
+        *   Si4703::seekUp() and seekDown().
+        * Returns:
+        *   SI4703_TUNE_COMPLETE or SI4703_TUNE_FAILED.
+        */
+        byte seekUp(bool wrap = true);
+        byte seekDown(bool wrap = true);
+
+        byte getState(void) { return _state; };
+
+        /*
+        * Description:
+        *   The RSSI false stops come in at around here, in dBuV, 0 if none
+        *   has been seen yet. It is what the noise and the splatter of
+        *   strong neighbours look like to the chip; a seek that goes all
+        *   the way around without keeping a stop halves it.
+        */
+        byte getNoiseFloor(void) { return _floor; };
+
+        /*
+        * Description:
+        *   Instrumentation counter: false stops skipped since construction.
+        */
+        unsigned long getRejected(void) { return _rejected; };
+
+    private:
+        Si4703 &_radio;
+        word _dwell;
+        byte _margin, _criteria;
+        byte _baseRSSI, _baseSNR, _baseCount;
+        byte _state, _step;
+        bool _up, _wrap;
+        byte _floor, _streak;
+        word _start, _last;
+        unsigned long _stamp, _sampled, _rejected;
+        //Dwell samples: RSSI total, how many, and how many showed stereo,
+        //RDS sync and a railed AFC
+        word _rssiSum;
+        byte _samples, _stereo, _rds, _afcrl;
+
+        bool seek(void);
+        bool passed(word frequency);
+        void goBack(void);
+        void sample(void);
+        void reject(void);
+        void finish(byte state);
+};
+
+#endif
@@ -0,0 +1,137 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the code file for the signal quality sampler.
+ * See the header file for better function documentation.
+ */
+
+#include "Si4703Telemetry.h"
+
+#include <util/atomic.h>
+
+Si4703Telemetry::Si4703Telemetry(Si4703 &radio, byte threshold,
+                                 byte interval) : _radio(radio) {
+    _threshold = threshold;
+    _interval = interval;
+    _held = false;
+    clear();
+}
+
+void Si4703Telemetry::begin(void) {
+    _radio._telemetry = this;
+}
+
+void Si4703Telemetry::end(void) {
+    if(_radio._telemetry == this) _radio._telemetry = NULL;
+}
+
+void Si4703Telemetry::clear(void) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _head = _count = 0;
+        _minimum = _maximum = 0;
+        _average = 0;
+        _timeAbove = _timeSampled = 0;
+    };
+}
+
+Si4703_Sample Si4703Telemetry::getSample(byte age) {
+    Si4703_Sample sample;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        const byte index = (_head + SI4703_TELEMETRY_SIZE - 1 - age) %
+                           SI4703_TELEMETRY_SIZE;
+
+        sample.rssi = _samples[index].rssi;
+        sample.flags = _samples[index].flags;
+        sample.bler = _samples[index].bler;
+    };
+
+    return sample;
+}
+
+byte Si4703Telemetry::getPercentile(byte percent) {
+    byte rssi[SI4703_TELEMETRY_SIZE];
+    byte count;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = _count;
+        for(byte i = 0; i < count; i++) rssi[i] = _samples[i].rssi;
+    };
+    if(!count) return 0;
+
+    //Insertion sort, the window is small
+    for(byte i = 1; i < count; i++) {
+        const byte value = rssi[i];
+        byte j = i;
+
+        while(j && rssi[j - 1] > value) {
+            rssi[j] = rssi[j - 1];
+            j--;
+        };
+        rssi[j] = value;
+    };
+
+    return rssi[((count - 1) * (word)min(percent, (byte)100) + 50) / 100];
+}
+
+byte Si4703Telemetry::getRatio(byte flags) {
+    byte count, matches = 0;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = _count;
+        for(byte i = 0; i < count; i++)
+            if((_samples[i].flags & flags) == flags) matches++;
+    };
+
+    return count ? (matches * 100U + count / 2) / count : 0;
+}
+
+void Si4703Telemetry::sample(bool bler) {
+    const unsigned long now = millis();
+    const word status = _radio._registers[SI4703_REG_STATUSRSSI];
+    const byte rssi = status & SI4703_RSSI_MASK;
+    volatile Si4703_Sample &sample = _samples[_head];
+
+    //Channels swept past or probed say nothing about the station, and the
+    //time spent away from it does not count either
+    if(_held || _radio._tuneState == SI4703_TUNE_BUSY) {
+        if(_count) _stamp = now;
+
+        return;
+    };
+    if(_count) {
+        const unsigned long elapsed = now - _stamp;
+
+        if(elapsed < _interval) return;
+        //Whatever the last sample said held until now
+        _timeSampled += elapsed;
+        if(_above) _timeAbove += elapsed;
+        _minimum = min(_minimum, rssi);
+        _maximum = max(_maximum, rssi);
+        _average += ((int)(rssi << 4) - (int)_average) / 8;
+    } else {
+        _minimum = _maximum = rssi;
+        _average = rssi << 4;
+    };
+    _stamp = now;
+    _above = rssi >= _threshold;
+
+    sample.rssi = rssi;
+    sample.flags = 0;
+    if(status & SI4703_STATUS_ST) sample.flags |= SI4703_SAMPLE_ST;
+    if(status & SI4703_STATUS_AFCRL) sample.flags |= SI4703_SAMPLE_AFCRL;
+    if(status & SI4703_STATUS_RDSS) sample.flags |= SI4703_SAMPLE_RDSS;
+    sample.bler = (status & SI4703_BLERA_MASK) >> 3;
+    if(bler && _radio._registers[SI4703_REG_SYSCONFIG1] & SI4703_FLG_RDS) {
+        sample.flags |= SI4703_SAMPLE_BLER;
+        sample.bler |= _radio._registers[SI4703_REG_READCHAN] >> 10 & 0x3F;
+    };
+    _head = (_head + 1) % SI4703_TELEMETRY_SIZE;
+    if(_count < SI4703_TELEMETRY_SIZE) _count++;
+}
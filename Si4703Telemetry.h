@@ -0,0 +1,145 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the include file for the signal quality sampler.
+ */
+
+#ifndef _SI4703TELEMETRY_H_INCLUDED
+#define _SI4703TELEMETRY_H_INCLUDED
+
+#include "Si4703.h"
+
+//How many samples the statistics window holds, 3 bytes each
+#ifndef SI4703_TELEMETRY_SIZE
+# define SI4703_TELEMETRY_SIZE 32
+#endif
+
+//Default shortest time between two samples, in ms. Reads come in bursts
+//(command processor, seek polling) that would otherwise crowd the window.
+#define SI4703_TELEMETRY_INTERVAL 10
+
+//Sample flags
+#define SI4703_SAMPLE_ST 0x01
+#define SI4703_SAMPLE_AFCRL 0x02
+#define SI4703_SAMPLE_RDSS 0x04
+//The bler field is valid: RDS was on and READCHAN was read along
+#define SI4703_SAMPLE_BLER 0x08
+
+/*
+* Description:
+*   One sample, 3 bytes.
+*   rssi  - in dBuV.
+*   flags - the SI4703_SAMPLE_* flags.
+*   bler  - block errors of the last RDS group, BLERA:BLERB:BLERC:BLERD from
+*           the most significant bits down, two bits each (0 = none, 1 = 1-2,
+*           2 = 3-5, 3 = uncorrectable).
+*/
+typedef struct {
+    byte rssi;
+    byte flags;
+    byte bler;
+} Si4703_Sample;
+
+class Si4703Telemetry
+{
+    public:
+        /*
+        * Description:
+        *   Binds the sampler to a radio. Nothing is recorded until begin().
+        * Parameters:
+        *   threshold - RSSI, in dBuV, that getTimeAbove() measures against.
+        *   interval  - see SI4703_TELEMETRY_INTERVAL.
+        */
+        Si4703Telemetry(Si4703 &radio, byte threshold = 20,
+                        byte interval = SI4703_TELEMETRY_INTERVAL);
+
+        /*
+        * Description:
+        *   Starts (and stops) sampling. Samples are taken from whatever
+        *   register reads the radio does anyway (interrupts, poll(),
+        *   refresh(), tuning...), so they cost no bus traffic at all; in
+        *   polling mode they come as often as the sketch asks for status.
+        *   One sampler per radio.
+        */
+        void begin(void);
+        void end(void);
+
+        /*
+        * Description:
+        *   Forgets all samples and statistics.
+        */
+        void clear(void);
+
+        /*
+        * Description:
+        *   Sample access: getCount() samples are in the window, age 0 is the
+        *   newest.
+        */
+        byte getCount(void) { return _count; };
+        Si4703_Sample getSample(byte age);
+
+        /*
+        * Description:
+        *   RSSI statistics, in dBuV. getMinimum() and getMaximum() cover
+        *   everything since clear(), getAverage() is an exponential moving
+        *   average (1/8 weight to the newest) and getPercentile() covers the
+        *   window.
+        * Parameters:
+        *   percent - 0 to 100, 50 being the median.
+        */
+        byte getMinimum(void) { return _minimum; };
+        byte getMaximum(void) { return _maximum; };
+        byte getAverage(void) { return (_average + 8) >> 4; };
+        byte getPercentile(byte percent);
+
+        /*
+        * Description:
+        *   How many of the samples in the window have all of flags set, in
+        *   percent, e.g. for stereo or RDS sync over the last while.
+        */
+        byte getRatio(byte flags);
+
+        /*
+        * Description:
+        *   Time spent with RSSI at or above the threshold, and total time
+        *   sampled, in ms since clear().
+        */
+        unsigned long getTimeAbove(void) { return _timeAbove; };
+        unsigned long getTimeSampled(void) { return _timeSampled; };
+        void setThreshold(byte threshold) { _threshold = threshold; };
+
+    private:
+        //Fed by the radio, see sample()
+        friend class Si4703;
+
+        Si4703 &_radio;
+        byte _threshold, _interval;
+        volatile Si4703_Sample _samples[SI4703_TELEMETRY_SIZE];
+        volatile byte _head, _count;
+        volatile byte _minimum, _maximum;
+        //In 1/16 dBuV
+        volatile word _average;
+        volatile unsigned long _timeAbove, _timeSampled;
+        unsigned long _stamp;
+        bool _above;
+        //See Si4703::holdTelemetry()
+        volatile bool _held;
+
+        /*
+        * Description:
+        *   Called by the radio, possibly from its ISR, after each register
+        *   read; takes a sample if the interval has passed, unless the chip
+        *   is tuning, seeking or held elsewhere.
+        * Parameters:
+        *   bler - READCHAN was part of the read.
+        */
+        void sample(bool bler);
+};
+
+#endif
@@ -0,0 +1,103 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the code file for the I2C transaction trace recorder.
+ * See the header file for better function documentation.
+ */
+
+#include "Si4703Trace.h"
+
+#include <string.h>
+
+#include <util/atomic.h>
+
+Si4703Trace::Si4703Trace(Si4703 &radio, byte *buffer, size_t size) :
+    _radio(radio) {
+    _buffer = buffer;
+    _size = size;
+    clear();
+}
+
+void Si4703Trace::begin(void) {
+    _radio._trace = this;
+}
+
+void Si4703Trace::end(void) {
+    if(_radio._trace == this) _radio._trace = NULL;
+}
+
+void Si4703Trace::clear(void) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _length = 0;
+        _dropped = 0;
+        _stamp = micros();
+    };
+}
+
+size_t Si4703Trace::decode(const byte *data, size_t length,
+                           Si4703_TraceRecord &record) {
+    size_t used = 1;
+
+    if(!length) return 0;
+    record.type = data[0] & SI4703_TRACE_TYPE_MASK;
+    record.nack = data[0] & SI4703_TRACE_NACK;
+    record.count = data[0] & SI4703_TRACE_COUNT_MASK;
+    //The fourth type is unused
+    if(record.type == SI4703_TRACE_TYPE_MASK ||
+       record.count > SI4703_LAST_REGISTER + 1 ||
+       (record.type == SI4703_TRACE_INTERRUPT && record.count))
+        return 0;
+
+    record.delta = 0;
+    for(byte shift = 0; ; shift += 7) {
+        if(used == length || shift > 28) return 0;
+        record.delta |= (unsigned long)(data[used] & 0x7F) << shift;
+        if(!(data[used++] & 0x80)) break;
+    };
+
+    if(length - used < record.count * 2U) return 0;
+    memset(record.registers, 0x00, sizeof(record.registers));
+    for(byte i = 0; i < record.count; i++) {
+        const byte reg = ((record.type == SI4703_TRACE_WRITE ?
+                           SI4703_FIRST_REGISTER_WRITE :
+                           SI4703_FIRST_REGISTER_READ) + i) &
+                         SI4703_LAST_REGISTER;
+
+        record.registers[reg] = word(data[used], data[used + 1]);
+        used += 2;
+    };
+
+    return used;
+}
+
+void Si4703Trace::record(byte type, unsigned long stamp, bool ack,
+                         const byte *data, byte count) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        //An interrupt recorded while a transaction was under way went in
+        //first, though it came after the transaction started
+        const unsigned long delta = (long)(stamp - _stamp) > 0 ?
+                                    stamp - _stamp : 0;
+        unsigned long rest = delta;
+        byte *out = _buffer + _length;
+
+        if(_dropped || _size - _length < SI4703_TRACE_MAX_RECORD)
+            _dropped++;
+        else {
+            *out++ = type | (ack ? 0 : SI4703_TRACE_NACK) | count;
+            while(rest > 0x7F) {
+                *out++ = 0x80 | (rest & 0x7F);
+                rest >>= 7;
+            };
+            *out++ = rest;
+            if(count) memcpy(out, data, count * 2);
+            _length = out + count * 2 - _buffer;
+            _stamp += delta;
+        };
+    };
+}
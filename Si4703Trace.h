@@ -0,0 +1,148 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This is the include file for the I2C transaction trace recorder.
+ *
+ * A trace is a sequence of records, each made of:
+ *   - a header byte: the record type (SI4703_TRACE_WRITE, _READ or
+ *     _INTERRUPT), SI4703_TRACE_NACK if the chip did not acknowledge and the
+ *     number of registers transferred. The Si4703 always writes from POWERCFG
+ *     and reads from STATUSRSSI on, so that is the whole register window.
+ *   - the time from the start of the previous record (or from begin()/
+ *     clear() for the first one) to the start of this one, in microseconds,
+ *     7 bits per byte, least significant first, the top bit set on all but
+ *     the last byte. Transactions start when they are handed to the
+ *     transport.
+ *   - the registers, most significant byte first, exactly as on the wire.
+ * Interrupt records carry no registers and mark the entry into the radio's
+ * interrupt handler.
+ */
+
+#ifndef _SI4703TRACE_H_INCLUDED
+#define _SI4703TRACE_H_INCLUDED
+
+#include "Si4703.h"
+
+//Record header
+#define SI4703_TRACE_WRITE 0x00
+#define SI4703_TRACE_READ 0x40
+#define SI4703_TRACE_INTERRUPT 0x80
+#define SI4703_TRACE_TYPE_MASK 0xC0
+#define SI4703_TRACE_NACK 0x20
+#define SI4703_TRACE_COUNT_MASK 0x1F
+
+//Longest record: header, a 32 bit time and all 16 registers
+#define SI4703_TRACE_MAX_RECORD (1 + 5 + (SI4703_LAST_REGISTER + 1) * 2)
+
+/*
+* Description:
+*   One decoded record, see Si4703Trace::decode().
+*   type      - SI4703_TRACE_WRITE, _READ or _INTERRUPT.
+*   nack      - the chip did not acknowledge the transaction.
+*   count     - number of registers transferred.
+*   delta     - microseconds since the start of the previous record.
+*   registers - indexed by register number, only the count registers from
+*               SI4703_FIRST_REGISTER_WRITE (writes) or
+*               SI4703_FIRST_REGISTER_READ (reads) on, wrapping around after
+*               SI4703_LAST_REGISTER, are filled in.
+*/
+typedef struct {
+    byte type;
+    bool nack;
+    byte count;
+    unsigned long delta;
+    word registers[SI4703_LAST_REGISTER + 1];
+} Si4703_TraceRecord;
+
+class Si4703Trace
+{
+    public:
+        /*
+        * Description:
+        *   Binds the recorder to a radio and to the memory the trace goes
+        *   into. Nothing is recorded until begin().
+        * Parameters:
+        *   buffer - where records go, for as long as they fit. Listening to
+        *            RDS takes about 80 bytes a second in interrupt mode and
+        *            ten times that when polling every 10ms.
+        *   size   - size of buffer, in bytes.
+        */
+        Si4703Trace(Si4703 &radio, byte *buffer, size_t size);
+
+        /*
+        * Description:
+        *   Starts (and stops) recording every transaction the radio makes,
+        *   including those from its interrupt handler. Recording costs no bus
+        *   traffic, only the time to copy the payload. One recorder per
+        *   radio.
+        */
+        void begin(void);
+        void end(void);
+
+        /*
+        * Description:
+        *   Empties the trace and restarts its clock.
+        */
+        void clear(void);
+
+        /*
+        * Description:
+        *   The trace so far, e.g. to write it out with
+        *   Serial.write(trace.getData(), trace.getLength()).
+        */
+        const byte *getData(void) { return _buffer; };
+        size_t getLength(void) { return _length; };
+
+        /*
+        * Description:
+        *   Number of records that did not fit in the buffer since clear().
+        *   Recording stops at the first of them, so the trace is always a
+        *   contiguous prefix of what happened.
+        */
+        unsigned long getDropped(void) { return _dropped; };
+
+        /*
+        * Description:
+        *   Decodes the record at the start of data.
+        * Parameters:
+        *   length - bytes available at data.
+        * Returns:
+        *   the size of the record in bytes, 0 if it is truncated or not a
+        *   valid record.
+        */
+        static size_t decode(const byte *data, size_t length,
+                             Si4703_TraceRecord &record);
+
+    private:
+        //Fed by the radio, see record()
+        friend class Si4703;
+
+        Si4703 &_radio;
+        byte *_buffer;
+        size_t _size;
+        volatile size_t _length;
+        volatile unsigned long _dropped;
+        volatile unsigned long _stamp;
+
+        /*
+        * Description:
+        *   Called by the radio, possibly from its ISR, after each transaction
+        *   and on entering its interrupt handler.
+        * Parameters:
+        *   type  - SI4703_TRACE_WRITE, _READ or _INTERRUPT.
+        *   stamp - micros() when the transaction started.
+        *   ack   - whether the chip acknowledged.
+        *   data  - the bytes transferred.
+        *   count - number of registers (twice as many bytes) in data.
+        */
+        void record(byte type, unsigned long stamp, bool ack,
+                    const byte *data, byte count);
+};
+
+#endif
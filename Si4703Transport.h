@@ -0,0 +1,254 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This library is for use with the SparkFun Si4703 Evaluation or Breakout
+ * Boards.
+ * See the example sketches to learn how to use the library in your code.
+ *
+ * This file contains the I2C transports the library can talk to the chip
+ * through. Each is a class with static inline members only, so the choice is
+ * made at compile time and costs neither a virtual call nor an object:
+ *   Si4703_WireTransport    - the Arduino Wire library (default).
+ *   Si4703_BitBangTransport - direct port access on any two AVR pins, at up
+ *                             to 400kHz and safe to use from within an ISR.
+ *   Si4703_LinuxTransport   - /dev/i2c-N, to drive the chip from an SBC.
+ *   Si4703_SimTransport     - straight into the simulated chip of the host
+ *                             build (see the README), bypassing Wire.
+ * Select one by defining SI4703_TRANSPORT to its name when compiling the
+ * library, e.g. -DSI4703_TRANSPORT=Si4703_BitBangTransport.
+ *
+ * A transport provides:
+ *   static void begin(void);
+ *   static bool read(byte address, byte *data, byte count);
+ *   static bool write(byte address, const byte *data, byte count);
+ * where read() and write() are whole transactions and return false if the
+ * chip did not acknowledge.
+ */
+
+#ifndef _SI4703TRANSPORT_H_INCLUDED
+#define _SI4703TRANSPORT_H_INCLUDED
+
+#if defined(ARDUINO) && ARDUINO >= 100
+# include <Arduino.h>
+#else
+# include <WProgram.h>
+#endif
+
+#ifndef SI4703_TRANSPORT
+# define SI4703_TRANSPORT Si4703_WireTransport
+#endif
+
+#define SI4703_TRANSPORT_Si4703_WireTransport 1
+#define SI4703_TRANSPORT_Si4703_BitBangTransport 2
+#define SI4703_TRANSPORT_Si4703_LinuxTransport 3
+#define SI4703_TRANSPORT_Si4703_SimTransport 4
+#define SI4703_TRANSPORT_ID(t) SI4703_TRANSPORT_ID_(t)
+#define SI4703_TRANSPORT_ID_(t) SI4703_TRANSPORT_##t
+
+#if SI4703_TRANSPORT_ID(SI4703_TRANSPORT) == \
+    SI4703_TRANSPORT_Si4703_WireTransport
+# include <Wire.h>
+
+class Si4703_WireTransport
+{
+    public:
+        static void begin(void) { Wire.begin(); };
+        static bool read(byte address, byte *data, byte count) {
+            if(Wire.requestFrom(address, count) != count) return false;
+            for(byte i = 0; i < count; i++) data[i] = Wire.read();
+
+            return true;
+        };
+        static bool write(byte address, const byte *data, byte count) {
+            Wire.beginTransmission(address);
+            for(byte i = 0; i < count; i++) Wire.write(data[i]);
+
+            return !Wire.endTransmission();
+        };
+};
+#elif SI4703_TRANSPORT_ID(SI4703_TRANSPORT) == \
+      SI4703_TRANSPORT_Si4703_BitBangTransport
+# ifndef __AVR__
+#  error Si4703_BitBangTransport needs direct AVR port access
+# endif
+# include <util/delay.h>
+
+//Pins to bit-bang on, SDA and SCL by default (so it can stand in for Wire
+//without rewiring); they need pull-ups, just like for Wire.
+# ifndef SI4703_BITBANG_SDA
+#  define SI4703_BITBANG_SDA SDA
+# endif
+# ifndef SI4703_BITBANG_SCL
+#  define SI4703_BITBANG_SCL SCL
+# endif
+//SCL low and high times in us, on top of the instructions themselves: the
+//I2C fast mode (400kHz) minimums by default, which is all the Si4703 is
+//rated for. High time counts from when SCL reads high, so the pull-ups'
+//rise time comes on top.
+# ifndef SI4703_BITBANG_TLOW
+#  define SI4703_BITBANG_TLOW 1.3
+# endif
+# ifndef SI4703_BITBANG_THIGH
+#  define SI4703_BITBANG_THIGH 0.6
+# endif
+//How many times SCL is looked at for the pull-up to raise it before going
+//on regardless, so a shorted bus cannot hang an ISR
+# ifndef SI4703_BITBANG_RISE_TRIES
+#  define SI4703_BITBANG_RISE_TRIES 255
+# endif
+
+class Si4703_BitBangTransport
+{
+    public:
+        static void begin(void) {
+            _sdaDDR = portModeRegister(digitalPinToPort(SI4703_BITBANG_SDA));
+            _sdaPIN = portInputRegister(digitalPinToPort(SI4703_BITBANG_SDA));
+            _sdaMask = digitalPinToBitMask(SI4703_BITBANG_SDA);
+            _sclDDR = portModeRegister(digitalPinToPort(SI4703_BITBANG_SCL));
+            _sclPIN = portInputRegister(digitalPinToPort(SI4703_BITBANG_SCL));
+            _sclMask = digitalPinToBitMask(SI4703_BITBANG_SCL);
+            //Open drain: PORT stays low, DDR decides between pulling the
+            //line down and letting the pull-up have it.
+            *portOutputRegister(digitalPinToPort(SI4703_BITBANG_SDA)) &=
+                ~_sdaMask;
+            *portOutputRegister(digitalPinToPort(SI4703_BITBANG_SCL)) &=
+                ~_sclMask;
+            sdaHigh();
+            sclHigh();
+        };
+        static bool read(byte address, byte *data, byte count) {
+            bool ack;
+
+            start();
+            ack = writeByte(address << 1 | 0x01);
+            for(byte i = 0; ack && i < count; i++)
+                data[i] = readByte(i == count - 1);
+            stop();
+
+            return ack;
+        };
+        static bool write(byte address, const byte *data, byte count) {
+            bool ack;
+
+            start();
+            ack = writeByte(address << 1);
+            for(byte i = 0; ack && i < count; i++) ack = writeByte(data[i]);
+            stop();
+
+            return ack;
+        };
+
+    private:
+        static volatile uint8_t *_sdaDDR, *_sdaPIN, *_sclDDR, *_sclPIN;
+        static uint8_t _sdaMask, _sclMask;
+
+        static void pauseLow(void) { _delay_us(SI4703_BITBANG_TLOW); };
+        static void pauseHigh(void) { _delay_us(SI4703_BITBANG_THIGH); };
+        static void sdaLow(void) { *_sdaDDR |= _sdaMask; };
+        static void sdaHigh(void) { *_sdaDDR &= ~_sdaMask; };
+        static void sclLow(void) { *_sclDDR |= _sclMask; };
+        //SCL low time is served here rather than in sclLow(), after SDA has
+        //been set up for the next bit; high time only once the line is up.
+        static void sclHigh(void) {
+            pauseLow();
+            *_sclDDR &= ~_sclMask;
+            for(byte i = 0; i < SI4703_BITBANG_RISE_TRIES &&
+                !(*_sclPIN & _sclMask); i++);
+            pauseHigh();
+        };
+        static bool sda(void) { return *_sdaPIN & _sdaMask; };
+        //Hold and setup times for START and STOP match SCL high time, bus
+        //free time after STOP its low time.
+        static void start(void) {
+            sdaHigh(); sclHigh(); sdaLow(); pauseHigh(); sclLow(); };
+        static void stop(void) {
+            sdaLow(); sclHigh(); sdaHigh(); pauseLow(); };
+        static bool writeByte(byte value) {
+            for(byte mask = 0x80; mask; mask >>= 1) {
+                if(value & mask) sdaHigh(); else sdaLow();
+                sclHigh();
+                sclLow();
+            };
+            sdaHigh();
+            sclHigh();
+            const bool ack = !sda();
+            sclLow();
+
+            return ack;
+        };
+        static byte readByte(bool last) {
+            byte value = 0;
+
+            sdaHigh();
+            for(byte i = 0; i < 8; i++) {
+                sclHigh();
+                value = value << 1 | sda();
+                sclLow();
+            };
+            //ACK all but the last byte
+            if(last) sdaHigh(); else sdaLow();
+            sclHigh();
+            sclLow();
+            sdaHigh();
+
+            return value;
+        };
+};
+#elif SI4703_TRANSPORT_ID(SI4703_TRANSPORT) == \
+      SI4703_TRANSPORT_Si4703_LinuxTransport
+# ifndef __linux__
+#  error Si4703_LinuxTransport needs Linux
+# endif
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/ioctl.h>
+# include <linux/i2c-dev.h>
+
+//The /dev/i2c-N adapter the chip hangs off, 1 on a Raspberry Pi
+# ifndef SI4703_LINUX_I2C_BUS
+#  define SI4703_LINUX_I2C_BUS "/dev/i2c-1"
+# endif
+
+class Si4703_LinuxTransport
+{
+    public:
+        static void begin(void) {
+            if(_fd < 0) _fd = open(SI4703_LINUX_I2C_BUS, O_RDWR);
+        };
+        static bool read(byte address, byte *data, byte count) {
+            return target(address) && ::read(_fd, data, count) == count;
+        };
+        static bool write(byte address, const byte *data, byte count) {
+            return target(address) && ::write(_fd, data, count) == count;
+        };
+
+    private:
+        static int _fd;
+
+        static bool target(byte address) {
+            return _fd >= 0 && ioctl(_fd, I2C_SLAVE, address) >= 0; };
+};
+#elif SI4703_TRANSPORT_ID(SI4703_TRANSPORT) == \
+      SI4703_TRANSPORT_Si4703_SimTransport
+//Provided by extras/host/Si4703Host.cpp
+bool Si4703Host_read(byte address, byte *data, byte count);
+bool Si4703Host_write(byte address, const byte *data, byte count);
+
+class Si4703_SimTransport
+{
+    public:
+        static void begin(void) {};
+        static bool read(byte address, byte *data, byte count) {
+            return Si4703Host_read(address, data, count); };
+        static bool write(byte address, const byte *data, byte count) {
+            return Si4703Host_write(address, data, count); };
+};
+#else
+# error Unknown SI4703_TRANSPORT
+#endif
+
+typedef SI4703_TRANSPORT Si4703_Transport;
+
+#endif
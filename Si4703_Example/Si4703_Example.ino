@@ -35,6 +35,8 @@
 *   f       - display currently tuned frequency
 *   q       - display RSSI for currently tuned station
 *   t       - display decoded status register
+*   i/I     - display/reset the instrumentation counters (only if the library
+*             was built with SI4703_INSTRUMENTATION, see Si4703.h)
 *   ?       - display this list
 *
 */
@@ -51,6 +53,67 @@ Si4703 radio;
 char command;
 word status, frequency;
 
+#if SI4703_INSTRUMENTATION
+//Names of the SI4703_OP_* entry points, in order
+const char opNames[SI4703_OPS][10] PROGMEM = {
+  "begin", "tune", "poll", "audio", "property", "status", "interrupt",
+  "other"
+};
+
+void printHistogram(const volatile word *histogram, unsigned long first)
+{
+  for(byte i = 0; i < SI4703_HISTOGRAM_BUCKETS; i++) {
+    Serial.print(F("  "));
+    if(i == SI4703_HISTOGRAM_BUCKETS - 1) Serial.print(F(">="));
+    else Serial.print(F("<"));
+    Serial.print(first << min(i, SI4703_HISTOGRAM_BUCKETS - 2));
+    Serial.print(F("us: "));
+    Serial.println(histogram[i]);
+  }
+}
+
+//One line per counter, easy to paste into a bug report
+void dumpStats()
+{
+  Si4703_Stats stats;
+  char name[10];
+
+  radio.getStats(stats);
+  Serial.println(F("Instrumentation {"));
+  for(byte op = 0; op < SI4703_OPS; op++) {
+    strcpy_P(name, opNames[op]);
+    Serial.print(F("* "));
+    Serial.print(name);
+    Serial.print(F(": "));
+    Serial.print(stats.transactions[op]);
+    Serial.print(F(" transactions, "));
+    Serial.print(stats.bytes[op]);
+    Serial.println(F(" bytes"));
+  }
+  Serial.print(F("* command processor spins: "));
+  Serial.println(stats.commandSpins);
+  Serial.print(F("* wait spins: "));
+  Serial.println(stats.waitSpins);
+  Serial.print(F("* interrupts: "));
+  Serial.print(stats.interrupts);
+  Serial.print(F(", "));
+  Serial.print(stats.interruptMicros);
+  Serial.print(F("us total, "));
+  Serial.print(stats.interruptMax);
+  Serial.println(F("us max"));
+  printHistogram(stats.interruptHistogram, SI4703_HISTOGRAM_INTERRUPT_MICROS);
+  Serial.print(F("* seeks/tunes: "));
+  Serial.print(stats.tunes);
+  Serial.print(F(", "));
+  Serial.print(stats.tuneMicros);
+  Serial.print(F("us total, "));
+  Serial.print(stats.tuneMax);
+  Serial.println(F("us max"));
+  printHistogram(stats.tuneHistogram, SI4703_HISTOGRAM_TUNE_MICROS);
+  Serial.println("}");
+}
+#endif
+
 void setup()
 {
   //Create a serial connection
@@ -131,6 +194,17 @@ void loop()
         Serial.println("}");
         Serial.flush();
         break;
+#if SI4703_INSTRUMENTATION
+      case 'i':
+        dumpStats();
+        Serial.flush();
+        break;
+      case 'I':
+        radio.resetStats();
+        Serial.println(F("Instrumentation counters reset"));
+        Serial.flush();
+        break;
+#endif
       case '?':
         Serial.println(F("Available commands:"));
         Serial.println(F("* v/V     - decrease/increase the volume"));
@@ -139,6 +213,9 @@ void loop()
         Serial.println(F("* f       - display currently tuned frequency"));
         Serial.println(F("* q       - display RSSI for current station"));
         Serial.println(F("* t       - display decoded status register"));
+#if SI4703_INSTRUMENTATION
+        Serial.println(F("* i/I     - display/reset instrumentation"));
+#endif
         Serial.println(F("* ?       - display this list"));
         Serial.flush();
         break;
@@ -0,0 +1,90 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This file is part of the host build, see the README for details.
+ *
+ * It stands in for the Arduino core when the library is compiled on a Linux
+ * workstation: pins, interrupts and time are all routed to the simulated
+ * Si4703 in Si4703Sim.h and time only advances when the code under test waits
+ * for it or talks on the bus.
+ */
+
+#ifndef _ARDUINO_H_INCLUDED
+#define _ARDUINO_H_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+
+typedef uint8_t byte;
+typedef uint16_t word;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+//Pin assignments of the Arduino Uno
+#define SS 10
+#define SDA 18
+#define SCL 19
+
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : \
+                                  NOT_AN_INTERRUPT))
+
+//Pin change interrupts, mapped like on the Uno. Changes are only noticed on
+//the simulated chips' GPIO2 pins, see Si4703Sim::setPins().
+extern volatile uint8_t PCICR, PCMSK0, PCMSK1, PCMSK2;
+#define digitalPinToPCICR(p) (((p) >= 0 && (p) <= 21) ? (&PCICR) : \
+                              ((volatile uint8_t *)0))
+#define digitalPinToPCICRbit(p) (((p) <= 7) ? 2 : (((p) <= 13) ? 0 : 1))
+#define digitalPinToPCMSK(p) (((p) <= 7) ? (&PCMSK2) : (((p) <= 13) ? \
+                              (&PCMSK0) : (((p) <= 21) ? (&PCMSK1) : \
+                              ((volatile uint8_t *)0))))
+#define digitalPinToPCMSKbit(p) (((p) <= 7) ? (p) : (((p) <= 13) ? \
+                                 ((p) - 8) : ((p) - 14)))
+
+//There is only one address space on the host
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define F(string) (string)
+
+#define lowByte(w) ((uint8_t)((w) & 0xFF))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define bit(b) (1UL << (b))
+
+template<typename T> static inline T min(T a, T b) { return a < b ? a : b; }
+template<typename T> static inline T max(T a, T b) { return a > b ? a : b; }
+
+static inline word makeWord(word w) { return w; }
+static inline word makeWord(byte h, byte l) { return (h << 8) | l; }
+#define word(...) makeWord(__VA_ARGS__)
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+void interrupts(void);
+void noInterrupts(void);
+
+#endif
@@ -0,0 +1,764 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This file is part of the host build, see the README for details.
+ *
+ * This is the I2C cost benchmark: it drives the library against the simulated
+ * chip and reports, for each API call, the number of I2C transactions, the
+ * bytes on the wire (address bytes included) and the time the bus was busy
+ * at 100kHz and 400kHz, in polling, (direct) interrupt and deferred interrupt
+ * mode.
+ *
+ * Usage: si4703-bench [--check BASELINE]
+ *   With --check, compares this run against the output of a previous one and
+ *   exits with status 1 if any operation got more expensive on the bus.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Si4703.h>
+#include <Si4703Scanner.h>
+#include <Si4703Presets.h>
+#include <Si4703Scheduler.h>
+#include <Si4703PCINT.h>
+#include <Si4703Telemetry.h>
+#include <Si4703AF.h>
+#include <Si4703SmartSeek.h>
+#include <avr/eeprom.h>
+
+#include <stdio.h>
+
+#include "Si4703Sim.h"
+
+#define SI4703BENCH_MAX_ROWS 160
+#define SI4703BENCH_SPEEDS 2
+
+typedef struct {
+    char operation[24];
+    char mode[10];
+    long result;
+    Si4703Sim_BusStats cost[SI4703BENCH_SPEEDS];
+} Si4703Bench_Row;
+
+static const unsigned long speeds[SI4703BENCH_SPEEDS] = { 100000, 400000 };
+
+static Si4703Bench_Row rows[SI4703BENCH_MAX_ROWS];
+static byte rowCount, row, speed;
+static const char *mode;
+static Si4703Sim_BusStats mark;
+
+static void setupStations(void) {
+    Si4703_Simulator.clear();
+    Si4703_Simulator.setPins(SI4703_PIN_RESET, SI4703_PIN_GPIO2);
+    Si4703_Simulator.addStation(8810, 42, true, 0x1234);
+    //Listed by 88.1 but another programme, as happens near network edges
+    Si4703_Simulator.addAlternativeFrequency(8810, 10110);
+    Si4703_Simulator.addAlternativeFrequency(8810, 9470);
+    Si4703_Simulator.addStation(8930, 24, false);
+    Si4703_Simulator.addStation(9470, 55, true, 0x1234);
+    Si4703_Simulator.addStation(10110, 38, true, 0x2345);
+    Si4703_Simulator.addStation(10450, 60, true);
+    Si4703_Simulator.setBlockErrorRate(5);
+
+    //The second chip, only reachable through the mux
+    Si4703Sim &second = Si4703_Simulators[1];
+
+    second.clear();
+    second.setPins(8, 3);
+    second.addStation(9210, 45, true, 0x3456);
+    second.addStation(10110, 38, true, 0x2345);
+    second.setBlockErrorRate(5);
+}
+
+static void start(void) {
+    mark = Si4703_HostBus;
+}
+
+static void stop(const char *operation, long result) {
+    Si4703Bench_Row &r = rows[row++];
+
+    if(!speed) {
+        snprintf(r.operation, sizeof(r.operation), "%s", operation);
+        snprintf(r.mode, sizeof(r.mode), "%s", mode);
+        r.result = result;
+        rowCount = row;
+    };
+    r.cost[speed].transactions = Si4703_HostBus.transactions -
+                                 mark.transactions;
+    r.cost[speed].bytes = Si4703_HostBus.bytes - mark.bytes;
+    r.cost[speed].micros = Si4703_HostBus.micros - mark.micros;
+}
+
+static void run(byte interrupt) {
+    word block[4];
+    long groups = 0;
+
+    mode = interrupt == SI4703_INT_DEFERRED ? "deferred" :
+           interrupt == SI4703_INT_DIRECT ? "interrupt" : "polling";
+    Si4703Host_reset();
+    Wire.setClock(speeds[speed]);
+
+    Si4703 radio;
+
+    start();
+    radio.begin(SI4703_BAND_WEST, true, interrupt);
+    stop("begin", 0);
+
+    start();
+    radio.seekUp();
+    stop("seekUp", Si4703_Simulator.getFrequency());
+
+    start();
+    stop("getFrequency", radio.getFrequency());
+
+    start();
+    stop("getRSSI", radio.getRSSI());
+
+    radio.volumeDown();
+    start();
+    stop("volumeUp", radio.volumeUp());
+
+    start();
+    radio.mute();
+    stop("mute", Si4703_Simulator.isMuted());
+    radio.unMute();
+
+    //Across the whole range, a step at a time and in one go
+    radio.setVolume(0);
+    start();
+    while(radio.volumeUp());
+    stop("volumeUp*30", radio.getVolume());
+    radio.setVolume(0);
+    start();
+    radio.setVolume(SI4703_VOLUME_MAX);
+    stop("setVolume", radio.getVolume());
+
+    //Five settings one at a time, then again as a transaction
+    start();
+    radio.mute();
+    radio.setVolume(20);
+    radio.setMono(true);
+    radio.setDeemphasis(SI4703_DE_75US);
+    radio.setSeekThresholds(25, 4, 8);
+    stop("configure", 0);
+
+    start();
+    radio.beginTransaction();
+    radio.unMute();
+    radio.setVolume(SI4703_VOLUME_MAX);
+    radio.setMono(false);
+    radio.setDeemphasis(SI4703_DE_50US);
+    radio.setSeekThresholds(0, 1, 1);
+    radio.commitTransaction();
+    stop("configure/transaction", 0);
+
+    start();
+    radio.setProperty(SI4703_PROP_BLEND_MONO_RSSI, 0x0010);
+    stop("setProperty", Si4703_Simulator.getProperty(
+        SI4703_PROP_BLEND_MONO_RSSI));
+
+    //Five properties one at a time, then again as a batch; the result is how
+    //long RDS was off for, in microseconds.
+    static const word properties[] = {
+        SI4703_PROP_FM_DETECTOR_SNR, SI4703_PROP_BLEND_MONO_RSSI,
+        SI4703_PROP_BLEND_STEREO_RSSI, SI4703_PROP_FM_DETECTOR_SNR,
+        SI4703_PROP_BLEND_MONO_RSSI
+    };
+    long outage = 0;
+
+    start();
+    for(byte i = 0; i < 5; i++) {
+        radio.setProperty(properties[i], 0x0010 + i);
+        outage += radio.getCommandLatency();
+    };
+    stop("setProperty*5", outage);
+
+    start();
+    radio.beginCommands();
+    for(byte i = 0; i < 5; i++) radio.setProperty(properties[i], 0x0020 + i);
+    radio.endCommands();
+    stop("setProperty*5/batch", radio.getCommandLatency());
+
+    //What the monitoring task does every second: read back a property we
+    //set, from the cache and then from the chip.
+    start();
+    stop("getProperty", radio.getProperty(SI4703_PROP_BLEND_MONO_RSSI));
+
+    start();
+    stop("getProperty/fresh", radio.getProperty(SI4703_PROP_BLEND_MONO_RSSI,
+                                                true));
+
+    //One second of listening, polling for RDS from loop() every 10ms
+    start();
+    for(byte i = 0; i < 100; i++) {
+        delay(10);
+        if(radio.readRDSGroup(block)) groups++;
+    };
+    stop("readRDSGroup/s", groups);
+
+    //Another second, this time from a sluggish loop() that only gets around
+    //to RDS every 250ms and drains the ring in one go; the result is the
+    //number of groups lost because the ring was full.
+    word blocks[SI4703_RDS_RING_SIZE][4];
+    Si4703_RDSStats before, after;
+
+    radio.getRDSStats(before);
+    start();
+    for(byte i = 0; i < 4; i++) {
+        delay(250);
+        radio.readRDSGroups(blocks, SI4703_RDS_RING_SIZE);
+    };
+    radio.getRDSStats(after);
+    stop("readRDSGroups/s", after.dropped - before.dropped);
+
+    //Seek on, this time driven from a 1ms loop(); the result is the longest
+    //we ever spent inside poll(), in microseconds.
+    unsigned long longest = 0;
+
+    start();
+    radio.startSeekUp();
+    do {
+        const unsigned long stamp = micros();
+
+        radio.poll();
+        longest = max(longest, micros() - stamp);
+        delay(1);
+    } while(radio.getTuneState() == SI4703_TUNE_BUSY);
+    stop("startSeekUp+poll", longest);
+
+    //Straight to a known station, no seeking
+    start();
+    radio.setFrequency(10110);
+    stop("setFrequency", Si4703_Simulator.getFrequency());
+
+    //Walk the whole band both ways, listening for PI codes where RDS can be
+    //had; the result is the number of stations found.
+    Si4703_Station table[8];
+    Si4703Scanner scanner(radio, table, 8);
+
+    start();
+    scanner.start(SI4703_SCAN_SEEK, 20, 0, interrupt ? 500 : 0);
+    while(scanner.poll() == SI4703_SCAN_BUSY) delay(1);
+    stop("scan/seek", scanner.getCount());
+
+    start();
+    scanner.start(SI4703_SCAN_TUNE, 20, 0, interrupt ? 500 : 0);
+    while(scanner.poll() == SI4703_SCAN_BUSY) delay(1);
+    stop("scan/tune", scanner.getCount());
+
+    //Keep a station as preset, to come back to it later; the result is the
+    //number of EEPROM cells programmed.
+    Si4703Presets presets(radio);
+    unsigned long writes = Si4703Host_eepromWrites;
+
+    presets.load();
+    radio.setFrequency(9470);
+    start();
+    presets.store(0);
+    presets.setRestoreOnBegin(true);
+    presets.update();
+    stop("presets/save", Si4703Host_eepromWrites - writes);
+
+    radio.setFrequency(8810);
+    start();
+    presets.recall(0);
+    stop("presets/recall", Si4703_Simulator.getFrequency());
+    presets.update();
+
+    //Power the chip down and back up, again from a 1ms loop(); the result is
+    //once more the longest we ever spent inside poll().
+    radio.end();
+    longest = 0;
+
+    start();
+    radio.startBegin(SI4703_BAND_WEST, true, interrupt);
+    do {
+        const unsigned long stamp = micros();
+
+        radio.poll();
+        longest = max(longest, micros() - stamp);
+        delay(1);
+    } while(!radio.isReady());
+    stop("startBegin+poll", longest);
+
+    //Cold start straight back to the last station; the result is the time
+    //to audio in ms.
+    radio.end();
+    start();
+    const unsigned long stamp = millis();
+
+    presets.begin(SI4703_BAND_WEST, true, interrupt);
+    stop("presets/begin", Si4703_Simulator.getFrequency() == 9470 ?
+         millis() - stamp : -1);
+
+    //Two tuners behind a mux, brought up and then listened to for a second,
+    //all from a 5ms loop(); the result is the number of RDS groups received.
+    radio.end();
+
+    Si4703 first(9, 2), second(8, 3);
+    Si4703Scheduler scheduler;
+
+    first.setBusSelector(Si4703Host_selectBus, 0);
+    second.setBusSelector(Si4703Host_selectBus, 1);
+    first.startBegin(SI4703_BAND_WEST, true, interrupt);
+    second.startBegin(SI4703_BAND_WEST, true, interrupt);
+    scheduler.add(first);
+    scheduler.add(second);
+    while(!first.isReady() || !second.isReady()) {
+        scheduler.run();
+        delay(5);
+    };
+    first.startSetFrequency(8810);
+    second.startSetFrequency(9210);
+    groups = 0;
+
+    start();
+    for(byte i = 0; i < 200; i++) {
+        scheduler.run();
+        groups += first.readRDSGroups(blocks, SI4703_RDS_RING_SIZE);
+        groups += second.readRDSGroups(blocks, SI4703_RDS_RING_SIZE);
+        delay(5);
+    };
+    stop("scheduler/s", groups);
+
+    //GPIO2 moved off the external interrupt pins to pin 7 (PCINT23): seek,
+    //then listen for a second from a 10ms loop(); the result is the number
+    //of RDS groups received.
+    first.end();
+    second.end();
+    Si4703Host_selectBus(0);
+    Si4703_Simulator.setPins(SI4703_PIN_RESET, 7);
+
+    Si4703 pinChange(SI4703_PIN_RESET, 7);
+
+    pinChange.begin(SI4703_BAND_WEST, true, interrupt);
+    start();
+    pinChange.seekUp();
+    stop("pcint/seekUp", Si4703_Simulator.getFrequency());
+
+    groups = 0;
+    start();
+    for(byte i = 0; i < 100; i++) {
+        pinChange.service();
+        groups += pinChange.readRDSGroups(blocks, SI4703_RDS_RING_SIZE);
+        delay(10);
+    };
+    stop("pcint/readRDSGroups/s", groups);
+
+    //Signal quality over another second of the same; the result is the
+    //number of samples taken, then the median RSSI computed from them.
+    Si4703Telemetry telemetry(pinChange);
+
+    telemetry.begin();
+    start();
+    for(byte i = 0; i < 100; i++) {
+        pinChange.service();
+        pinChange.readRDSGroups(blocks, SI4703_RDS_RING_SIZE);
+        //What polling sketches do anyway
+        if(!interrupt && !(i % 4)) pinChange.refresh();
+        delay(10);
+    };
+    stop("telemetry/s", telemetry.getCount());
+
+    start();
+    stop("telemetry/median", telemetry.getPercentile(50));
+
+    telemetry.end();
+
+    //Wait for the next RDS Clock Time group from a 10ms loop() that only
+    //gets around to the ring every 250ms. Once the group comes out of the
+    //ring, the results are how far off the simulated wall clock
+    //getClockTime() is, in ms, and how far off taking the group as current
+    //would have been. The chip signals the group at its end, up to 88ms
+    //after the minute edge the group is about.
+    //The simulated wall clock, in ms since the Unix epoch
+    const unsigned long long epoch =
+        ((SI4703SIM_EPOCH_MJD - SI4703_MJD_UNIX) * 86400ULL +
+         SI4703SIM_EPOCH_HOUR * 3600UL) * 1000;
+    Si4703_ClockTime clock;
+    long error = -1, naive = -1;
+
+    start();
+    for(word i = 0; naive == -1 && i < 18200; i++) {
+        pinChange.service();
+        //What Si4703Scheduler does for polled radios
+        if(!interrupt && !(i % 3)) pinChange.refresh();
+        if(!(i % 25)) {
+            const byte count = pinChange.readRDSGroups(blocks,
+                                                       SI4703_RDS_RING_SIZE);
+
+            for(byte j = 0; j < count; j++)
+                if((blocks[j][1] & SI4703_RDS_GROUP_MASK) ==
+                   SI4703_RDS_GROUP_4A && pinChange.getClockTime(clock)) {
+                    error = clock.utc * 1000ULL + clock.millis -
+                            (epoch + millis());
+                    naive = error - clock.age;
+                };
+        };
+        delay(10);
+    };
+    stop("clockTime", error);
+    start();
+    stop("clockTime/ring", naive);
+
+    //A second of the same loop() keeping only 0A groups; the result is the
+    //number of groups that came out of the ring, -1 if any was not 0A.
+    pinChange.setRDSFilter(SI4703_RDS_TYPE_A(0));
+    groups = 0;
+    start();
+    for(byte i = 0; groups != -1 && i < 100; i++) {
+        pinChange.service();
+        if(!interrupt && !(i % 3)) pinChange.refresh();
+        if(!(i % 25)) {
+            const byte count = pinChange.readRDSGroups(blocks,
+                                                       SI4703_RDS_RING_SIZE);
+
+            for(byte j = 0; groups != -1 && j < count; j++)
+                groups = blocks[j][1] >> SI4703_RDS_GROUP_SHIFT ? -1 :
+                         groups + 1;
+        };
+        delay(10);
+    };
+    stop("readRDSGroups/filter", groups);
+    pinChange.setRDSFilter(SI4703_RDS_TYPE_ALL);
+
+    //Ten seconds of groups thrown away for block errors, first only taking
+    //error free ones, then allowing for corrected errors
+    for(byte tolerant = 0; tolerant < 2; tolerant++) {
+        pinChange.setRDSErrorTolerance(tolerant ?
+            SI4703_RDS_BLER(SI4703_BLER_12, SI4703_BLER_12, SI4703_BLER_12,
+                            SI4703_BLER_12) :
+            SI4703_RDS_BLER(SI4703_BLER_0, SI4703_BLER_0, SI4703_BLER_0,
+                            SI4703_BLER_0));
+        pinChange.getRDSStats(before);
+        start();
+        for(word i = 0; i < 1000; i++) {
+            pinChange.service();
+            if(!interrupt && !(i % 3)) pinChange.refresh();
+            if(!(i % 25))
+                pinChange.readRDSGroups(blocks, SI4703_RDS_RING_SIZE);
+            delay(10);
+        };
+        pinChange.getRDSStats(after);
+        stop(tolerant ? "rdsErrors/tolerant" : "rdsErrors/strict",
+             after.rejected - before.rejected);
+    };
+    pinChange.setRDSErrorTolerance(SI4703_RDS_BLER(SI4703_BLER_0,
+        SI4703_BLER_0, SI4703_BLER_0, SI4703_BLER_0));
+
+    //Driving out of 88.1's coverage, from the same 10ms loop(): listen for
+    //ten seconds to learn its AF list, then fade it out from under the
+    //radio. The results are how long it took to land on 94.7 (same PI,
+    //unlike 101.1) in ms, -1 if it never did, then the longest the audio
+    //was muted for in one go, in ms.
+    Si4703AF follower(pinChange);
+    unsigned long arrived, faded = 0, muted = 0;
+    long landed = -1, mute = 0;
+    byte errors;
+
+    start();
+    follower.start();
+    for(word i = 0; landed == -1 && i < 6000; i++) {
+        pinChange.service();
+        if(!interrupt && !(i % 3)) pinChange.refresh();
+        if(follower.poll() != SI4703_AF_PROBING)
+            while(pinChange.readRDSGroup(block, arrived, errors))
+                follower.process(block, errors);
+        if(i == 1000) {
+            Si4703_Simulator.setStationRSSI(8810, 10);
+            faded = millis();
+        };
+        if(Si4703_Simulator.isMuted()) {
+            if(!muted) muted = millis();
+        } else if(muted) {
+            mute = max(mute, (long)(millis() - muted));
+            muted = 0;
+        };
+        if(follower.getSwitches())
+            landed = Si4703_Simulator.getFrequency() == 9470 ?
+                     millis() - faded : -2;
+        delay(10);
+    };
+    stop("af/follow", landed);
+    start();
+    stop("af/mute", mute);
+    Si4703_Simulator.setStationRSSI(8810, 42);
+
+    //Walk the band from the bottom, with the chip's seek and then with the
+    //smart one, from a 1ms loop(); the results are the number of stops
+    //made, then the number kept, the number of false stops skipped and the
+    //noise floor measured on the way.
+    Si4703SmartSeek smart(pinChange);
+    long stops = 0;
+
+    pinChange.setFrequency(Si4703_BandBottom(SI4703_BAND_WEST));
+    start();
+    while(pinChange.startSeekUp(false)) {
+        while(pinChange.poll() == SI4703_TUNE_BUSY) delay(1);
+        if(pinChange.getTuneState() == SI4703_TUNE_FAILED) break;
+        stops++;
+    };
+    stop("seekUp/walk", stops);
+
+    pinChange.setFrequency(Si4703_BandBottom(SI4703_BAND_WEST));
+    stops = 0;
+    start();
+    while(smart.start(true, false)) {
+        while(smart.poll() == SI4703_TUNE_BUSY) delay(1);
+        if(smart.getState() == SI4703_TUNE_FAILED) break;
+        stops++;
+    };
+    stop("smartSeek/walk", stops);
+    start();
+    stop("smartSeek/rejected", smart.getRejected());
+    start();
+    stop("smartSeek/floor", smart.getNoiseFloor());
+    pinChange.setSeekThresholds(0, 1, 1);
+
+    //Warm start back to the same station, to compare with presets/begin;
+    //the result is the time to audio in ms.
+    pinChange.setFrequency(9470);
+    pinChange.suspend();
+    delay(1000);
+    start();
+    const unsigned long woken = millis();
+
+    pinChange.resume();
+    stop("suspend/resume", Si4703_Simulator.getFrequency() == 9470 ?
+         millis() - woken : -1);
+
+    //RDS and interrupts must come back with it; the result is the number of
+    //RDS groups received in a second, from a 10ms loop().
+    groups = 0;
+    start();
+    for(byte i = 0; i < 100; i++) {
+        pinChange.service();
+        if(!interrupt) pinChange.refresh();
+        groups += pinChange.readRDSGroups(blocks, SI4703_RDS_RING_SIZE);
+        delay(10);
+    };
+    stop("resume/rds", groups);
+
+    //Half a second on the station, then a seek from a 1ms loop() with the
+    //sampler still on: the empty channels swept past (RSSI 10) must not show
+    //up; the result is the minimum RSSI. Back to the station afterwards.
+    const word listened = pinChange.getFrequency();
+
+    telemetry.clear();
+    telemetry.begin();
+    start();
+    for(byte i = 0; i < 50; i++) {
+        pinChange.service();
+        pinChange.readRDSGroups(blocks, SI4703_RDS_RING_SIZE);
+        if(!interrupt && !(i % 4)) pinChange.refresh();
+        delay(10);
+    };
+    pinChange.startSeekUp();
+    do {
+        pinChange.service();
+        delay(1);
+    } while(pinChange.poll() == SI4703_TUNE_BUSY);
+    stop("telemetry/seek", telemetry.getMinimum());
+    telemetry.end();
+    pinChange.setFrequency(listened);
+
+    //Five tunes, each looked at again only 270ms later, by when the tune
+    //completed and the first RDS group came in; the result is how many
+    //groups were counted as dropped, none of them actually was.
+    pinChange.getRDSStats(before);
+    start();
+    for(byte i = 0; i < 5; i++) {
+        pinChange.startSetFrequency(i % 2 ? listened : 8810);
+        delay(270);
+        pinChange.poll();
+        pinChange.readRDSGroups(blocks, SI4703_RDS_RING_SIZE);
+    };
+    pinChange.getRDSStats(after);
+    stop("tune/dropped", after.dropped - before.dropped);
+    pinChange.setFrequency(listened);
+
+    //end() in the middle of a seek, then begin() again: the seek must be
+    //forgotten; the result is whether a new one could be started.
+    pinChange.startSeekUp();
+    pinChange.end();
+    start();
+    pinChange.begin(SI4703_BAND_WEST, true, interrupt);
+    const bool restarted = pinChange.startSeekUp();
+
+    if(restarted)
+        while(pinChange.poll() == SI4703_TUNE_BUSY) delay(1);
+    stop("end/begin/seek", restarted);
+    pinChange.setFrequency(listened);
+
+    //Without the crystal, then a command: the result is TEST1 as the chip
+    //has it afterwards, reserved bits and all (0x0100 after reset).
+    pinChange.end();
+    pinChange.begin(SI4703_BAND_WEST, false, interrupt);
+    start();
+    pinChange.setProperty(SI4703_PROP_BLEND_MONO_RSSI, 0x0010);
+    stop("setProperty/test1", Si4703_Simulator.getRegister(SI4703_REG_TEST1));
+    pinChange.end();
+    pinChange.begin(SI4703_BAND_WEST, true, interrupt);
+    pinChange.setFrequency(listened);
+
+    //Transactions the chip does not acknowledge: failed reads must leave
+    //the shadow and the sampler alone and a failed write must go out again
+    //with the next one. The results are the samples taken over five failed
+    //reads, then the chip's volume after a failed setVolume() and an
+    //unMute().
+    telemetry.clear();
+    telemetry.begin();
+    Si4703_Simulator.failTransactions(0xFF);
+    start();
+    for(byte i = 0; i < 5; i++) {
+        delay(20);
+        pinChange.getRSSI();
+    };
+    Si4703_Simulator.failTransactions(0);
+    stop("nack/telemetry", telemetry.getCount());
+    telemetry.end();
+
+    Si4703_Simulator.failTransactions(1);
+    start();
+    pinChange.setVolume(3);
+    pinChange.unMute();
+    stop("nack/setVolume", Si4703_Simulator.getRegister(SI4703_REG_SYSCONFIG2) &
+                           SI4703_VOLUME_MASK);
+    pinChange.setVolume(SI4703_VOLUME_MAX);
+
+    //A measurement read on one station, then again on another: the result
+    //is the SNR the second read returns, which must be that station's.
+    pinChange.getProperty(SI4703_PROP_SNRDB);
+    pinChange.setFrequency(8930);
+    start();
+    stop("getProperty/SNRDB", pinChange.getProperty(SI4703_PROP_SNRDB));
+    pinChange.setFrequency(listened);
+
+    //A smart seek with the noise floor measured above: the result is SEEKTH
+    //as the chip has it afterwards, which must be back to the base of 0.
+    start();
+    if(smart.start(true, true))
+        while(smart.poll() == SI4703_TUNE_BUSY) delay(1);
+    stop("smartSeek/seekth",
+         (Si4703_Simulator.getRegister(SI4703_REG_SYSCONFIG2) &
+          SI4703_SEEKTH_MASK) >> SI4703_SEEKTH_SHIFT);
+    pinChange.setFrequency(listened);
+
+    //88.1 fading with 94.7 too weak to switch to, from the 10ms loop()
+    //above: ten seconds to learn the AF list, then twenty more. The result
+    //is how many times 101.1, another station, was probed.
+    Si4703AF decoy(pinChange);
+    word probed = 0;
+    bool there = false;
+
+    pinChange.setFrequency(8810);
+    decoy.start();
+    start();
+    for(word i = 0; i < 3000; i++) {
+        pinChange.service();
+        if(!interrupt && !(i % 3)) pinChange.refresh();
+        if(decoy.poll() != SI4703_AF_PROBING)
+            while(pinChange.readRDSGroup(block, arrived, errors))
+                decoy.process(block, errors);
+        if(i == 1000) {
+            Si4703_Simulator.setStationRSSI(8810, 10);
+            Si4703_Simulator.setStationRSSI(9470, 10);
+        };
+        if(Si4703_Simulator.getFrequency() == 10110) {
+            if(!there) probed++;
+            there = true;
+        } else
+            there = false;
+        delay(10);
+    };
+    stop("af/decoy", probed);
+    Si4703_Simulator.setStationRSSI(8810, 42);
+    Si4703_Simulator.setStationRSSI(9470, 55);
+    pinChange.setFrequency(listened);
+
+#if SI4703_INSTRUMENTATION
+    //The driver's own accounting of a seek must agree with the bus; the
+    //result is the number of transactions it counted.
+    Si4703_Stats stats;
+    long transactions = 0;
+
+    pinChange.resetStats();
+    start();
+    pinChange.seekUp();
+    pinChange.getStats(stats);
+    for(byte op = 0; op < SI4703_OPS; op++)
+        transactions += stats.transactions[op];
+    stop("stats/seekUp", transactions);
+#endif
+}
+
+static bool check(const char *baseline) {
+    FILE *file = fopen(baseline, "r");
+    char line[160];
+    bool good = true;
+
+    if(!file) {
+        perror(baseline);
+        return false;
+    };
+    while(fgets(line, sizeof(line), file)) {
+        Si4703Bench_Row old;
+
+        if(line[0] == '#' ||
+           sscanf(line, "%23s %9s %ld %lu %lu %lu %lu %lu %lu", old.operation,
+                  old.mode, &old.result, &old.cost[0].transactions,
+                  &old.cost[0].bytes, &old.cost[0].micros,
+                  &old.cost[1].transactions, &old.cost[1].bytes,
+                  &old.cost[1].micros) != 9)
+            continue;
+        for(byte i = 0; i < rowCount; i++) {
+            if(strcmp(rows[i].operation, old.operation) ||
+               strcmp(rows[i].mode, old.mode))
+                continue;
+            for(byte s = 0; s < SI4703BENCH_SPEEDS; s++)
+                if(rows[i].cost[s].transactions > old.cost[s].transactions ||
+                   rows[i].cost[s].bytes > old.cost[s].bytes) {
+                    printf("# REGRESSION: %s (%s) at %lukHz: %lu/%lu -> "
+                           "%lu/%lu transactions/bytes\n", old.operation,
+                           old.mode, speeds[s] / 1000,
+                           old.cost[s].transactions, old.cost[s].bytes,
+                           rows[i].cost[s].transactions, rows[i].cost[s].bytes);
+                    good = false;
+                };
+        };
+    };
+    fclose(file);
+
+    return good;
+}
+
+int main(int argc, char **argv) {
+    unsigned long violations = 0;
+
+    for(speed = 0; speed < SI4703BENCH_SPEEDS; speed++) {
+        row = 0;
+        for(byte interrupt = SI4703_INT_NONE;
+            interrupt <= SI4703_INT_DEFERRED; interrupt++) {
+            setupStations();
+            run(interrupt);
+            for(byte chip = 0; chip < SI4703SIM_CHIPS; chip++)
+                violations += Si4703_Simulators[chip].getViolations();
+        };
+    };
+
+    printf("# %-21s %-9s %6s %6s %6s %8s %6s %6s %8s\n", "operation", "mode",
+           "result", "tx", "bytes", "us@100k", "tx", "bytes", "us@400k");
+    for(byte i = 0; i < rowCount; i++)
+        printf("%-23s %-9s %6ld %6lu %6lu %8lu %6lu %6lu %8lu\n",
+               rows[i].operation, rows[i].mode, rows[i].result,
+               rows[i].cost[0].transactions, rows[i].cost[0].bytes,
+               rows[i].cost[0].micros, rows[i].cost[1].transactions,
+               rows[i].cost[1].bytes, rows[i].cost[1].micros);
+    printf("# datasheet violations: %lu\n", violations);
+
+    if(argc == 3 && !strcmp(argv[1], "--check") && !check(argv[2])) return 1;
+
+    return violations ? 2 : 0;
+}
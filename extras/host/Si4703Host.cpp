@@ -0,0 +1,287 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This file is part of the host build, see the README for details.
+ *
+ * This is the implementation of the Arduino core and Wire stand-ins.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <util/atomic.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+#include <Si4703-private.h>
+
+#include "Si4703Sim.h"
+
+//Longest stretch of simulated time between two looks at the chip
+#define SI4703HOST_STEP_MICROS 500UL
+//Simulated cost of a yield()ing spin loop iteration
+#define SI4703HOST_YIELD_MICROS 100UL
+
+Si4703Sim_BusStats Si4703_HostBus;
+TwoWire Wire;
+unsigned long Si4703Host_eepromWrites;
+volatile uint8_t PCICR, PCMSK0, PCMSK1, PCMSK2;
+
+static unsigned long _now;
+static bool _interruptsEnabled, _inInterrupt;
+static byte _bus;
+static void (*_handlers[2])(void);
+static void (* const _pinChangeVectors[3])(void) = {
+    PCINT0_vect, PCINT1_vect, PCINT2_vect
+};
+//Last GPIO2 level seen and pin change interrupts waiting for the I flag
+static byte _pinLevels[SI4703SIM_CHIPS];
+static byte _pinChanges;
+//Comes erased from the factory and, unlike everything else, survives resets
+static uint8_t _eeprom[E2END + 1];
+static bool _eepromErased;
+
+void Si4703Host_reset(void) {
+    _now = 0;
+    _interruptsEnabled = true;
+    _inInterrupt = false;
+    memset(_handlers, 0x00, sizeof(_handlers));
+    memset(&Si4703_HostBus, 0x00, sizeof(Si4703_HostBus));
+    Si4703Host_eepromWrites = 0;
+    if(!_eepromErased) {
+        memset(_eeprom, 0xFF, sizeof(_eeprom));
+        _eepromErased = true;
+    };
+    _bus = 0;
+    PCICR = PCMSK0 = PCMSK1 = PCMSK2 = 0;
+    _pinChanges = 0;
+    for(byte chip = 0; chip < SI4703SIM_CHIPS; chip++) {
+        Si4703_Simulators[chip].powerCycle();
+        _pinLevels[chip] = HIGH;
+    };
+}
+
+/*
+* Description:
+*   Latches a pin change interrupt for every GPIO2 that changed level and is
+*   enabled in PCMSKn, like the PCIFR flags would, and raises them once the I
+*   flag allows. Unlike external interrupts, both edges count.
+*/
+static void dispatchPinChanges(void) {
+    for(byte chip = 0; chip < SI4703SIM_CHIPS; chip++) {
+        const byte pin = Si4703_Simulators[chip].getGPIO2Pin();
+        const byte level = Si4703_Simulators[chip].getPin(pin);
+
+        if(level == _pinLevels[chip]) continue;
+        _pinLevels[chip] = level;
+        if(digitalPinToInterrupt(pin) == NOT_AN_INTERRUPT &&
+           *digitalPinToPCMSK(pin) & bit(digitalPinToPCMSKbit(pin)))
+            _pinChanges |= bit(digitalPinToPCICRbit(pin));
+    };
+    for(byte bank = 0; bank < 3; bank++) {
+        if(!(_pinChanges & bit(bank)) || !(PCICR & bit(bank)) ||
+           !_pinChangeVectors[bank] || !_interruptsEnabled || _inInterrupt)
+            continue;
+        _pinChanges &= ~bit(bank);
+
+        _inInterrupt = true;
+        _interruptsEnabled = false;
+        _pinChangeVectors[bank]();
+        _interruptsEnabled = true;
+        _inInterrupt = false;
+    };
+}
+
+static void dispatchInterrupts(void) {
+    for(byte chip = 0; chip < SI4703SIM_CHIPS; chip++) {
+        Si4703Sim &sim = Si4703_Simulators[chip];
+        const int interrupt = digitalPinToInterrupt(sim.getGPIO2Pin());
+
+        //No nesting, the AVR clears the I flag on entry
+        if(interrupt == NOT_AN_INTERRUPT || !_handlers[interrupt] ||
+           !_interruptsEnabled || _inInterrupt)
+            continue;
+        if(!sim.takeEdge()) continue;
+
+        _inInterrupt = true;
+        _interruptsEnabled = false;
+        _handlers[interrupt]();
+        _interruptsEnabled = true;
+        _inInterrupt = false;
+    };
+    dispatchPinChanges();
+}
+
+void Si4703Host_advance(unsigned long us) {
+    while(us) {
+        const unsigned long step = min(us, SI4703HOST_STEP_MICROS);
+
+        _now += step;
+        us -= step;
+        for(byte chip = 0; chip < SI4703SIM_CHIPS; chip++)
+            Si4703_Simulators[chip].update(_now);
+        dispatchInterrupts();
+    };
+}
+
+void Si4703Host_selectBus(byte bus) {
+    _bus = bus < SI4703SIM_CHIPS ? bus : 0;
+}
+
+bool Si4703Host_interruptsEnabled(void) {
+    return _interruptsEnabled;
+}
+
+unsigned long millis(void) {
+    return _now / 1000;
+}
+
+unsigned long micros(void) {
+    return _now;
+}
+
+void delay(unsigned long ms) {
+    Si4703Host_advance(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+    Si4703Host_advance(us);
+}
+
+void yield(void) {
+    Si4703Host_advance(SI4703HOST_YIELD_MICROS);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    for(byte chip = 0; chip < SI4703SIM_CHIPS; chip++)
+        Si4703_Simulators[chip].setPin(pin, value);
+}
+
+int digitalRead(uint8_t pin) {
+    //Open drain, any chip can pull a pin low
+    for(byte chip = 0; chip < SI4703SIM_CHIPS; chip++)
+        if(Si4703_Simulators[chip].getPin(pin) == LOW) return LOW;
+
+    return HIGH;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode) {
+    //The Si4703 only ever pulls GPIO2 low
+    if(interrupt < 2 && mode == FALLING) _handlers[interrupt] = handler;
+}
+
+void detachInterrupt(uint8_t interrupt) {
+    if(interrupt < 2) _handlers[interrupt] = NULL;
+}
+
+void interrupts(void) {
+    _interruptsEnabled = true;
+    if(!_inInterrupt) dispatchInterrupts();
+}
+
+void noInterrupts(void) {
+    _interruptsEnabled = false;
+}
+
+uint8_t eeprom_read_byte(const uint8_t *address) {
+    return _eeprom[(uintptr_t)address & E2END];
+}
+
+void eeprom_update_byte(uint8_t *address, uint8_t value) {
+    uint8_t &cell = _eeprom[(uintptr_t)address & E2END];
+
+    if(cell != value) {
+        cell = value;
+        Si4703Host_eepromWrites++;
+    };
+}
+
+void eeprom_read_block(void *destination, const void *source, size_t count) {
+    for(size_t i = 0; i < count; i++)
+        ((uint8_t *)destination)[i] = eeprom_read_byte(
+            (const uint8_t *)source + i);
+}
+
+void eeprom_update_block(const void *source, void *destination,
+                         size_t count) {
+    for(size_t i = 0; i < count; i++)
+        eeprom_update_byte((uint8_t *)destination + i,
+                           ((const uint8_t *)source)[i]);
+}
+
+/*
+* Description:
+*   Accounts for a completed transaction of count bytes (address byte
+*   included) and lets the simulated time run for its duration, at whatever
+*   clock Wire was set to whether or not it is the transport in use.
+*/
+static void transfer(byte count) {
+    const unsigned long clock = Wire.getClock();
+    //9 clocks per byte (8 data + ACK) plus the START and STOP conditions
+    const unsigned long duration = ((count * 9UL + 2) * 1000000UL + clock - 1) /
+                                   clock;
+
+    Si4703_HostBus.transactions++;
+    Si4703_HostBus.bytes += count;
+    Si4703_HostBus.micros += duration;
+    Si4703Host_advance(duration);
+}
+
+bool Si4703Host_read(byte address, byte *data, byte count) {
+    const bool ack = address == SI4703_I2C_ADDR &&
+                     Si4703_Simulators[_bus].read(data, count);
+
+    transfer(ack ? count + 1 : 1);
+
+    return ack;
+}
+
+bool Si4703Host_write(byte address, const byte *data, byte count) {
+    const bool ack = address == SI4703_I2C_ADDR &&
+                     Si4703_Simulators[_bus].write(data, count);
+
+    //Nothing past the address byte goes out if it isn't acknowledged
+    transfer(ack ? count + 1 : 1);
+
+    return ack;
+}
+
+TwoWire::TwoWire(void) {
+    _clock = 100000UL;
+    _txLength = _rxLength = _rxIndex = 0;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    _address = address;
+    _txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    if(_txLength == BUFFER_LENGTH) return 0;
+    _txBuffer[_txLength++] = data;
+
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool stop) {
+    //2 is what the AVR implementation returns for an address NACK
+    return Si4703Host_write(_address, _txBuffer, _txLength) ? 0 : 2;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity) {
+    quantity = min(quantity, (uint8_t)BUFFER_LENGTH);
+    _rxIndex = 0;
+    _rxLength = Si4703Host_read(address, _rxBuffer, quantity) ? quantity : 0;
+
+    return _rxLength;
+}
+
+int TwoWire::read(void) {
+    if(_rxIndex == _rxLength) return -1;
+
+    return _rxBuffer[_rxIndex++];
+}
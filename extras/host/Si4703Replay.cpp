@@ -0,0 +1,514 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This file is part of the host build, see the README for details.
+ *
+ * This is the trace replay tool: it takes a trace recorded by Si4703Trace
+ * (on a board or on the host), works out the power-ups, tunes and seeks the
+ * application asked for and asks the library being built for the same, at
+ * the same times, against the simulated chip playing the trace back (see
+ * Si4703Sim::play()). In between, it runs an application loop that reads RDS
+ * groups. It then prints what the trace and the replay cost on the bus and
+ * how long the operations took, side by side; replaying one trace with two
+ * builds of the library compares them on identical input.
+ *
+ * Usage: si4703-replay [OPTIONS] TRACE
+ *        si4703-replay [OPTIONS] --record TRACE
+ *        si4703-replay --dump TRACE
+ *   --mode polling|interrupt|deferred  how the library waits on the chip;
+ *                                      interrupt if TRACE has interrupts in
+ *                                      it, polling otherwise.
+ *   --clock HZ                         I2C clock, 100000 by default.
+ *   --loop MS                          application loop period, 10 by
+ *                                      default.
+ *   --save FILE                        writes the trace of the replay out.
+ *   --record                           instead of replaying, records a short
+ *                                      session against the behavioral model
+ *                                      into TRACE.
+ *   --dump                             instead of replaying, prints TRACE one
+ *                                      record per line.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Si4703.h>
+#include <Si4703Trace.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Si4703Sim.h"
+
+//Room for over an hour of RDS, even when polling every 10ms
+#define SI4703REPLAY_TRACE_SIZE (4UL << 20)
+#define SI4703REPLAY_MAX_OPERATIONS 1024
+//Give up on a tune or seek after this long, in ms
+#define SI4703REPLAY_TIMEOUT 10000UL
+
+typedef struct {
+    unsigned long stamp;
+    byte start;
+    word registers[SI4703_LAST_REGISTER + 1];
+} Si4703Replay_Operation;
+
+typedef struct {
+    unsigned long duration;
+    unsigned long reads, writes, nacks, interrupts;
+    //On the wire, address bytes included
+    unsigned long bytes, busMicros;
+    //From the write that started them to the first read that saw STC
+    unsigned long tunes, tuneMicros, tuneMax;
+    unsigned long seeks, seekMicros, seekMax;
+    //From entering the interrupt handler to the end of the read it made
+    unsigned long services, serviceMicros, serviceMax;
+    unsigned long groups;
+} Si4703Replay_Summary;
+
+static byte input[SI4703REPLAY_TRACE_SIZE], output[SI4703REPLAY_TRACE_SIZE];
+static Si4703Replay_Operation operations[SI4703REPLAY_MAX_OPERATIONS];
+static unsigned long busClock = 100000UL, loopMillis = 10, delivered;
+
+static unsigned long average(unsigned long total, unsigned long count) {
+    return count ? (total + count / 2) / count : 0;
+}
+
+/*
+* Description:
+*   Walks a trace and adds up what it cost. Latencies are measured the same
+*   way whatever recorded the trace, so two summaries always compare.
+*/
+static bool summarize(const byte *trace, size_t length,
+                      Si4703Replay_Summary &summary) {
+    Si4703_TraceRecord record;
+    word written[SI4703_LAST_REGISTER + 1], state[SI4703_LAST_REGISTER + 1];
+    word group[4];
+    unsigned long stamp = 0, interrupt = 0, started = 0, arrived = 0;
+    byte operation = SI4703SIM_START_NONE;
+    bool interrupted = false;
+
+    memset(&summary, 0x00, sizeof(summary));
+    memset(written, 0x00, sizeof(written));
+    memset(state, 0x00, sizeof(state));
+    memset(group, 0x00, sizeof(group));
+    for(size_t at = 0, used; at < length; at += used) {
+        used = Si4703Trace::decode(trace + at, length - at, record);
+        if(!used) return false;
+        stamp += record.delta;
+
+        if(record.type == SI4703_TRACE_INTERRUPT) {
+            summary.interrupts++;
+            interrupt = stamp;
+            interrupted = true;
+            continue;
+        };
+
+        //Same as the host bus: 9 clocks a byte, plus START and STOP
+        const unsigned long bytes = record.nack ? 1 : record.count * 2 + 1;
+
+        summary.bytes += bytes;
+        summary.busMicros += ((bytes * 9 + 2) * 1000000UL + busClock - 1) /
+                             busClock;
+        if(record.nack) {
+            summary.nacks++;
+            continue;
+        };
+
+        if(record.type == SI4703_TRACE_WRITE) {
+            word previous[SI4703_LAST_REGISTER + 1];
+
+            summary.writes++;
+            memcpy(previous, written, sizeof(written));
+            for(byte i = 0; i < record.count; i++)
+                written[SI4703_FIRST_REGISTER_WRITE + i] =
+                    record.registers[SI4703_FIRST_REGISTER_WRITE + i];
+
+            const byte start = Si4703Sim::classifyWrite(previous, written);
+
+            if(start == SI4703SIM_START_TUNE ||
+               start == SI4703SIM_START_SEEK) {
+                operation = start;
+                started = stamp;
+            };
+            continue;
+        };
+
+        summary.reads++;
+        for(byte i = 0; i < record.count; i++) {
+            const byte reg = (SI4703_FIRST_REGISTER_READ + i) &
+                             SI4703_LAST_REGISTER;
+
+            state[reg] = record.registers[reg];
+        };
+        if(interrupted) {
+            const unsigned long service = stamp - interrupt;
+
+            summary.services++;
+            summary.serviceMicros += service;
+            summary.serviceMax = max(summary.serviceMax, service);
+            interrupted = false;
+        };
+        if(operation != SI4703SIM_START_NONE &&
+           state[SI4703_REG_STATUSRSSI] & SI4703_STATUS_STC) {
+            const unsigned long latency = stamp - started;
+
+            if(operation == SI4703SIM_START_TUNE) {
+                summary.tunes++;
+                summary.tuneMicros += latency;
+                summary.tuneMax = max(summary.tuneMax, latency);
+            } else {
+                summary.seeks++;
+                summary.seekMicros += latency;
+                summary.seekMax = max(summary.seekMax, latency);
+            };
+            operation = SI4703SIM_START_NONE;
+        };
+        //Same rule as Si4703Sim::play(): whole groups only, new if different
+        //or if the last one must have been gone by then
+        if(state[SI4703_REG_STATUSRSSI] & SI4703_STATUS_RDSR &&
+           record.count >= SI4703_REG_RDSD - SI4703_REG_STATUSRSSI + 1 &&
+           (memcmp(group, &state[SI4703_REG_RDSA], sizeof(group)) ||
+            stamp - arrived >= SI4703SIM_RDSR_MICROS)) {
+            memcpy(group, &state[SI4703_REG_RDSA], sizeof(group));
+            arrived = stamp;
+            summary.groups++;
+        };
+    };
+    summary.duration = stamp;
+
+    return true;
+}
+
+/*
+* Description:
+*   Picks the power-ups, tunes and seeks out of a trace, with the registers
+*   as written when each was started.
+* Returns:
+*   the number of operations found.
+*/
+static size_t extract(const byte *trace, size_t length) {
+    Si4703_TraceRecord record;
+    word written[SI4703_LAST_REGISTER + 1];
+    unsigned long stamp = 0;
+    size_t count = 0;
+
+    memset(written, 0x00, sizeof(written));
+    for(size_t at = 0; at < length; ) {
+        at += Si4703Trace::decode(trace + at, length - at, record);
+        stamp += record.delta;
+        if(record.type != SI4703_TRACE_WRITE || record.nack) continue;
+
+        word previous[SI4703_LAST_REGISTER + 1];
+
+        memcpy(previous, written, sizeof(written));
+        for(byte i = 0; i < record.count; i++)
+            written[SI4703_FIRST_REGISTER_WRITE + i] =
+                record.registers[SI4703_FIRST_REGISTER_WRITE + i];
+
+        const byte start = Si4703Sim::classifyWrite(previous, written);
+
+        if(start == SI4703SIM_START_NONE) continue;
+        if(count == SI4703REPLAY_MAX_OPERATIONS) {
+            fprintf(stderr, "Too many operations, ignoring the rest\n");
+            break;
+        };
+        operations[count].stamp = stamp;
+        operations[count].start = start;
+        memcpy(operations[count].registers, written, sizeof(written));
+        count++;
+    };
+    //The band is only configured after the power-up, take it from whatever
+    //comes next
+    for(size_t i = 0; i < count; i++)
+        if(operations[i].start == SI4703SIM_START_POWERUP)
+            operations[i].registers[SI4703_REG_SYSCONFIG2] =
+                (i + 1 < count ? operations[i + 1].registers :
+                 written)[SI4703_REG_SYSCONFIG2];
+
+    return count;
+}
+
+/*
+* Description:
+*   One pass of the application loop: advance the radio, collect RDS groups,
+*   then sleep until the next pass.
+*/
+static byte step(Si4703 &radio) {
+    word block[4];
+
+    //Nothing to do but wait for the application to power the radio up
+    if(!radio.isReady()) {
+        delay(loopMillis);
+
+        return SI4703_TUNE_IDLE;
+    };
+
+    const byte state = radio.getInterruptMode() || radio.getTuneState() ==
+                       SI4703_TUNE_BUSY ? radio.poll() : SI4703_TUNE_IDLE;
+
+    //Polling applications have to go get RDS themselves
+    if(!radio.getInterruptMode() && state != SI4703_TUNE_BUSY)
+        radio.refresh();
+    while(radio.readRDSGroup(block)) delivered++;
+    delay(loopMillis);
+
+    return state;
+}
+
+static void listen(Si4703 &radio, unsigned long duration) {
+    const unsigned long started = micros();
+
+    while(micros() - started < duration) step(radio);
+}
+
+/*
+* Description:
+*   Runs the application loop until playback reaches stamp.
+*/
+static void wait(Si4703 &radio, unsigned long stamp) {
+    while((long)(Si4703_Simulator.getPlaybackTime() - stamp) < 0)
+        step(radio);
+}
+
+static void finish(Si4703 &radio) {
+    const unsigned long started = millis();
+
+    while(step(radio) == SI4703_TUNE_BUSY &&
+          millis() - started < SI4703REPLAY_TIMEOUT);
+}
+
+static void replay(Si4703 &radio, size_t count, unsigned long duration,
+                   byte mode) {
+    byte band = SI4703_BAND_WEST, space = SI4703_SPACE_100K;
+    //How long begin() took to get to the power-up, assuming the trace was
+    //started right before it
+    unsigned long lead = 0;
+
+    for(size_t i = 0; i < count; i++)
+        if(operations[i].start == SI4703SIM_START_POWERUP) {
+            lead = operations[i].stamp;
+            break;
+        };
+    for(size_t i = 0; i < count; i++) {
+        const Si4703Replay_Operation &operation = operations[i];
+        const word *regs = operation.registers;
+
+        //Playback lines up with each operation the driver starts, so this
+        //keeps the traced gaps between them
+        if(operation.start == SI4703SIM_START_POWERUP)
+            wait(radio, operation.stamp - min(lead, operation.stamp));
+        else
+            wait(radio, operation.stamp);
+        switch(operation.start) {
+            case SI4703SIM_START_POWERUP:
+                band = regs[SI4703_REG_SYSCONFIG2] & SI4703_BAND_MASK;
+                space = regs[SI4703_REG_SYSCONFIG2] & SI4703_SPACE_MASK;
+                radio.begin(band, regs[SI4703_REG_TEST1] & SI4703_FLG_XOSCEN,
+                            mode);
+                if(radio.getSpacing() != space) radio.setBand(band, space);
+                break;
+            case SI4703SIM_START_TUNE:
+                radio.startSetFrequency(Si4703_ChannelToFrequency(
+                    regs[SI4703_REG_CHANNEL] & SI4703_CHAN_MASK, band, space));
+                finish(radio);
+                break;
+            case SI4703SIM_START_SEEK:
+                if(regs[SI4703_REG_POWERCFG] & SI4703_FLG_SEEKUP)
+                    radio.startSeekUp(!(regs[SI4703_REG_POWERCFG] &
+                                        SI4703_FLG_SKMODE));
+                else
+                    radio.startSeekDown(!(regs[SI4703_REG_POWERCFG] &
+                                          SI4703_FLG_SKMODE));
+                finish(radio);
+                break;
+        };
+    };
+    wait(radio, duration);
+}
+
+static void record(Si4703 &radio, byte mode) {
+    const unsigned long second = 1000000UL;
+
+    Si4703_Simulator.setPins(SI4703_PIN_RESET, SI4703_PIN_GPIO2);
+    Si4703_Simulator.addStation(8810, 42, true, 0x1234);
+    Si4703_Simulator.addStation(8930, 24, false);
+    Si4703_Simulator.addStation(9470, 55, true, 0x1234);
+    Si4703_Simulator.addStation(10110, 38, true, 0x2345);
+    Si4703_Simulator.setBlockErrorRate(5);
+
+    radio.begin(SI4703_BAND_WEST, true, mode);
+    radio.startSetFrequency(10110);
+    finish(radio);
+    listen(radio, 3 * second);
+    for(byte i = 0; i < 3; i++) {
+        radio.startSeekUp();
+        finish(radio);
+        listen(radio, 2 * second);
+    };
+    radio.startSeekDown();
+    finish(radio);
+    listen(radio, 2 * second);
+}
+
+/*
+* Description:
+*   Prints a trace one record per line: time, type, then the registers.
+*/
+static bool dump(const byte *trace, size_t length) {
+    static const char types[] = "WRI";
+    Si4703_TraceRecord record;
+    unsigned long stamp = 0;
+
+    for(size_t at = 0, used; at < length; at += used) {
+        used = Si4703Trace::decode(trace + at, length - at, record);
+        if(!used) return false;
+        stamp += record.delta;
+
+        const byte first = record.type == SI4703_TRACE_WRITE ?
+                           SI4703_FIRST_REGISTER_WRITE :
+                           SI4703_FIRST_REGISTER_READ;
+
+        printf("%10lu %c%c", stamp, types[record.type >> 6],
+               record.nack ? '!' : ' ');
+        for(byte i = 0; i < record.count; i++)
+            printf(" %02X:%04X", (first + i) & SI4703_LAST_REGISTER,
+                   record.registers[(first + i) & SI4703_LAST_REGISTER]);
+        printf("\n");
+    };
+
+    return true;
+}
+
+static void print(const char *name, unsigned long recorded,
+                  unsigned long replayed) {
+    printf("%-24s %10lu %10lu\n", name, recorded, replayed);
+}
+
+static void usage(void) {
+    fprintf(stderr, "Usage: si4703-replay [--mode polling|interrupt|deferred]"
+                    " [--clock HZ] [--loop MS]\n"
+                    "                     [--save FILE] [--record | --dump]"
+                    " TRACE\n");
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    const char *name = NULL, *save = NULL;
+    int mode = -1;
+    bool recording = false, dumping = false;
+
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "--record")) recording = true;
+        else if(!strcmp(argv[i], "--dump")) dumping = true;
+        else if(i + 1 == argc || argv[i][0] != '-') {
+            if(name) usage();
+            name = argv[i];
+        } else if(!strcmp(argv[i], "--mode")) {
+            const char *value = argv[++i];
+
+            mode = !strcmp(value, "polling") ? SI4703_INT_NONE :
+                   !strcmp(value, "interrupt") ? SI4703_INT_DIRECT :
+                   !strcmp(value, "deferred") ? SI4703_INT_DEFERRED : -1;
+            if(mode < 0) usage();
+        } else if(!strcmp(argv[i], "--clock")) busClock = atol(argv[++i]);
+        else if(!strcmp(argv[i], "--loop")) loopMillis = atol(argv[++i]);
+        else if(!strcmp(argv[i], "--save")) save = argv[++i];
+        else usage();
+    };
+    if(!name || !busClock) usage();
+
+    Si4703Host_reset();
+    Wire.setClock(busClock);
+
+    Si4703 radio;
+    Si4703Trace trace(radio, output, sizeof(output));
+    Si4703Replay_Summary recorded, replayed;
+    size_t length = 0;
+
+    if(recording) {
+        trace.begin();
+        record(radio, mode < 0 ? SI4703_INT_DIRECT : mode);
+        trace.end();
+        save = name;
+    } else {
+        FILE *file = fopen(name, "rb");
+
+        if(!file) {
+            perror(name);
+            return 1;
+        };
+        length = fread(input, 1, sizeof(input), file);
+        fclose(file);
+        if(dumping) {
+            if(dump(input, length)) return 0;
+            fprintf(stderr, "%s: not a trace\n", name);
+            return 1;
+        };
+        if(!summarize(input, length, recorded) ||
+           !Si4703_Simulator.play(input, length)) {
+            fprintf(stderr, "%s: not a trace\n", name);
+            return 1;
+        };
+        if(mode < 0)
+            mode = recorded.interrupts ? SI4703_INT_DIRECT : SI4703_INT_NONE;
+        Si4703_Simulator.setPins(SI4703_PIN_RESET, SI4703_PIN_GPIO2);
+
+        const size_t count = extract(input, length);
+
+        trace.begin();
+        replay(radio, count, recorded.duration, mode);
+        trace.end();
+    };
+    radio.end();
+
+    if(trace.getDropped())
+        fprintf(stderr, "Trace full, %lu records dropped\n",
+                trace.getDropped());
+    if(save) {
+        FILE *file = fopen(save, "wb");
+
+        if(!file || fwrite(trace.getData(), 1, trace.getLength(), file) !=
+                    trace.getLength()) {
+            perror(save);
+            return 1;
+        };
+        fclose(file);
+    };
+    summarize(trace.getData(), trace.getLength(), replayed);
+    if(recording) recorded = replayed;
+
+    Si4703_RDSStats stats;
+    char bus[32];
+
+    radio.getRDSStats(stats);
+    printf("# %-22s %10s %10s\n", "", "recorded", "replayed");
+    print("duration(us)", recorded.duration, replayed.duration);
+    print("reads", recorded.reads, replayed.reads);
+    print("writes", recorded.writes, replayed.writes);
+    print("nacks", recorded.nacks, replayed.nacks);
+    print("interrupts", recorded.interrupts, replayed.interrupts);
+    print("bytes", recorded.bytes, replayed.bytes);
+    snprintf(bus, sizeof(bus), "bus(us@%lukHz)", busClock / 1000);
+    print(bus, recorded.busMicros, replayed.busMicros);
+    print("tunes", recorded.tunes, replayed.tunes);
+    print("tune(us) average", average(recorded.tuneMicros, recorded.tunes),
+          average(replayed.tuneMicros, replayed.tunes));
+    print("tune(us) max", recorded.tuneMax, replayed.tuneMax);
+    print("seeks", recorded.seeks, replayed.seeks);
+    print("seek(us) average", average(recorded.seekMicros, recorded.seeks),
+          average(replayed.seekMicros, replayed.seeks));
+    print("seek(us) max", recorded.seekMax, replayed.seekMax);
+    print("service(us) average",
+          average(recorded.serviceMicros, recorded.services),
+          average(replayed.serviceMicros, replayed.services));
+    print("service(us) max", recorded.serviceMax, replayed.serviceMax);
+    print("rds groups read", recorded.groups, replayed.groups);
+    printf("# rds groups delivered %lu, accepted %lu, rejected %lu, "
+           "dropped %lu, filtered %lu\n", delivered, stats.accepted,
+           stats.rejected, stats.dropped, stats.filtered);
+    printf("# datasheet violations: %lu\n",
+           Si4703_Simulator.getViolations());
+
+    return 0;
+}
@@ -0,0 +1,722 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This file is part of the host build, see the README for details.
+ *
+ * This is the behavioral model of the Si4703.
+ * See the header file for better function documentation.
+ */
+
+#include "Si4703Sim.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SI4703SIM_POWER_OFF 0
+#define SI4703SIM_POWER_BOOTING 1
+#define SI4703SIM_POWER_ON 2
+
+#define SI4703SIM_OPERATION_NONE 0
+#define SI4703SIM_OPERATION_TUNE 1
+#define SI4703SIM_OPERATION_SEEK 2
+
+//AF codes as per IEC 62106
+#define SI4703SIM_AF_NONE 224
+#define SI4703SIM_AF_FILLER 205
+
+Si4703Sim Si4703_Simulators[SI4703SIM_CHIPS];
+Si4703Sim &Si4703_Simulator = Si4703_Simulators[0];
+
+Si4703Sim::Si4703Sim(void) {
+    _pinReset = SI4703_PIN_RESET;
+    _pinGPIO2 = SI4703_PIN_GPIO2;
+    _snapshots = NULL;
+    _events = _starts = NULL;
+    clear();
+}
+
+void Si4703Sim::clear(void) {
+    _stationCount = 0;
+    _noiseFloor = 10;
+    _errorRate = 0;
+    _failures = 0;
+    stopPlaying();
+    powerCycle();
+}
+
+void Si4703Sim::powerCycle(void) {
+    _now = 0;
+    _violations = 0;
+    _random = 1;
+    _offset = _startedAt = 0;
+    _nextEvent = _nextStart = 0;
+    _completion = 0x0000;
+    //#RST has a pull-down on the SparkFun boards
+    setPin(_pinReset, LOW);
+}
+
+bool Si4703Sim::addStation(word frequency, byte rssi, bool stereo, word pi) {
+    if(_stationCount == SI4703SIM_MAX_STATIONS) return false;
+
+    Si4703Sim_Station &station = _stations[_stationCount++];
+    station.frequency = frequency;
+    station.rssi = rssi;
+    station.stereo = stereo;
+    station.pi = pi;
+    station.afCount = 0;
+
+    return true;
+}
+
+bool Si4703Sim::addAlternativeFrequency(word frequency, word af) {
+    Si4703Sim_Station *station = (Si4703Sim_Station *)findStation(frequency);
+
+    if(!station || station->afCount == SI4703SIM_MAX_AF) return false;
+    station->af[station->afCount++] = af;
+
+    return true;
+}
+
+bool Si4703Sim::setStationRSSI(word frequency, byte rssi) {
+    Si4703Sim_Station *station = (Si4703Sim_Station *)findStation(frequency);
+
+    if(!station) return false;
+    station->rssi = rssi;
+
+    return true;
+}
+
+void Si4703Sim::setPin(byte pin, byte level) {
+    if(pin != _pinReset) return;
+
+    if(level == LOW) {
+        //Everything is lost while in reset
+        _inReset = true;
+        memset(_regs, 0x00, sizeof(_regs));
+        _regs[SI4703_REG_DEVICEID] = SI4703_PN_SI4702_3 | SI4703_MFGID_SILABS;
+        _regs[SI4703_REG_CHIPID] = SI4703_REV_C | SI4703_DEV_SI4703_OFF |
+                                   SI4703_FIRMWARE_OFF;
+        _regs[SI4703_REG_TEST1] = 0x0100;
+        _power = SI4703SIM_POWER_OFF;
+        _operation = SI4703SIM_OPERATION_NONE;
+        _channel = 0;
+        _rdsrUntil = _gpio2Until = 0;
+        _edge = _commandPending = false;
+        _groupIndex = 0;
+        memset(_propertyIds, 0x00, sizeof(_propertyIds));
+    } else
+        _inReset = false;
+}
+
+byte Si4703Sim::getPin(byte pin) {
+    if(pin == _pinGPIO2 && _gpio2Until) return LOW;
+
+    return HIGH;
+}
+
+bool Si4703Sim::takeEdge(void) {
+    const bool edge = _edge;
+
+    _edge = false;
+
+    return edge;
+}
+
+bool Si4703Sim::write(const byte *data, byte count) {
+    if(_inReset) {
+        _violations++;
+        return false;
+    };
+    if(_failures) {
+        _failures--;
+        return false;
+    };
+    if(count & 0x01 || _power == SI4703SIM_POWER_BOOTING) _violations++;
+
+    word previous[SI4703_LAST_REGISTER + 1];
+    bool command = false;
+
+    memcpy(previous, _regs, sizeof(_regs));
+    for(byte i = 0; i < count / 2; i++) {
+        const byte reg = (SI4703_FIRST_REGISTER_WRITE + i) &
+                         SI4703_LAST_REGISTER;
+        const word value = word(data[2 * i], data[2 * i + 1]);
+
+        switch(reg) {
+            case SI4703_REG_DEVICEID:
+            case SI4703_REG_CHIPID:
+            case SI4703_REG_STATUSRSSI:
+            case SI4703_REG_READCHAN:
+                //Read-only
+                break;
+            case SI4703_REG_RDSA:
+            case SI4703_REG_RDSB:
+            case SI4703_REG_RDSC:
+            case SI4703_REG_RDSD:
+                //Only writable when the command processor is reachable
+                if(_regs[SI4703_REG_SYSCONFIG1] & SI4703_FLG_RDS) break;
+                _regs[reg] = value;
+                if(reg == SI4703_REG_RDSD) command = true;
+                break;
+            default:
+                _regs[reg] = value;
+        };
+    };
+
+    if(_snapshotCount && classifyWrite(previous, _regs)) alignPlayback();
+    applyWrite(previous);
+    if(command && lowByte(_regs[SI4703_REG_RDSD]) && !_snapshotCount) {
+        _commandPending = true;
+        _commandAt = _now + SI4703SIM_COMMAND_MICROS;
+    };
+
+    return true;
+}
+
+bool Si4703Sim::read(byte *data, byte count) {
+    if(_inReset) {
+        _violations++;
+        return false;
+    };
+    if(_failures) {
+        _failures--;
+        //What floats on the bus
+        memset(data, 0xFF, count);
+        return false;
+    };
+
+    if(_snapshotCount) playStatus(); else refreshStatus();
+    for(byte i = 0; i < count / 2; i++) {
+        const word value = _regs[(SI4703_FIRST_REGISTER_READ + i) &
+                                 SI4703_LAST_REGISTER];
+
+        data[2 * i] = highByte(value);
+        data[2 * i + 1] = lowByte(value);
+    };
+
+    return true;
+}
+
+void Si4703Sim::update(unsigned long now) {
+    if(now < _now) return;
+    _now = now;
+    if(_inReset) return;
+
+    if(_power == SI4703SIM_POWER_BOOTING && _now >= _powerAt) {
+        _power = SI4703SIM_POWER_ON;
+        _regs[SI4703_REG_CHIPID] = SI4703_REV_C | SI4703_DEV_SI4703_ON |
+                                   SI4703_FIRMWARE_ON;
+        _tunedAt = _now;
+        _groupAt = _now + SI4703SIM_RDS_SYNC_MICROS;
+    };
+    if(_gpio2Until && _now >= _gpio2Until) _gpio2Until = 0;
+    if(_rdsrUntil && _now >= _rdsrUntil) {
+        _regs[SI4703_REG_STATUSRSSI] &= ~SI4703_STATUS_RDSR;
+        _rdsrUntil = 0;
+    };
+    if(_snapshotCount) {
+        //Everything else comes from the trace
+        while(_nextEvent < _eventCount &&
+              _now - _offset >= _events[_nextEvent]) {
+            pulseGPIO2();
+            _nextEvent++;
+        };
+
+        return;
+    };
+    if(_commandPending && _now >= _commandAt) runCommand();
+    if(_power != SI4703SIM_POWER_ON) return;
+
+    while(_operation != SI4703SIM_OPERATION_NONE && _now >= _operationAt) {
+        if(_operation == SI4703SIM_OPERATION_TUNE) {
+            completeOperation(false);
+            break;
+        };
+
+        const int last = channelCount();
+        int next = _channel + (
+            _regs[SI4703_REG_POWERCFG] & SI4703_FLG_SEEKUP ? 1 : -1);
+
+        if(next > last || next < 0) {
+            if(_regs[SI4703_REG_POWERCFG] & SI4703_FLG_SKMODE) {
+                //Stop at the band limit
+                completeOperation(true);
+                break;
+            };
+            next = next < 0 ? last : 0;
+        };
+        _channel = next;
+        if(_channel == _seekStart) completeOperation(true);
+        else if(validStop(_channel)) completeOperation(false);
+        else _operationAt += SI4703SIM_TUNE_MICROS;
+    };
+
+    if(_operation == SI4703SIM_OPERATION_NONE)
+        while(_now >= _groupAt) {
+            receiveGroup();
+            _groupAt += SI4703SIM_RDS_GROUP_MICROS;
+        };
+}
+
+word Si4703Sim::getProperty(word property) {
+    for(byte i = 0; i < SI4703SIM_MAX_PROPERTIES; i++)
+        if(_propertyIds[i] == property) return _propertyValues[i];
+
+    return 0x0000;
+}
+
+bool Si4703Sim::isMuted(void) {
+    return _power != SI4703SIM_POWER_ON ||
+           !(_regs[SI4703_REG_POWERCFG] & SI4703_FLG_DMUTE) ||
+           !(_regs[SI4703_REG_SYSCONFIG2] & SI4703_VOLUME_MASK);
+}
+
+word Si4703Sim::bandBottom(void) {
+    return _regs[SI4703_REG_SYSCONFIG2] & SI4703_BAND_MASK ? 7600 : 8750;
+}
+
+word Si4703Sim::bandTop(void) {
+    return (_regs[SI4703_REG_SYSCONFIG2] & SI4703_BAND_MASK) ==
+        SI4703_BAND_EAST ? 9000 : 10800;
+}
+
+byte Si4703Sim::spacing(void) {
+    return 20 >> ((_regs[SI4703_REG_SYSCONFIG2] & SI4703_SPACE_MASK) >> 4);
+}
+
+int Si4703Sim::channelCount(void) {
+    return (bandTop() - bandBottom()) / spacing();
+}
+
+word Si4703Sim::channelFrequency(int channel) {
+    return bandBottom() + channel * spacing();
+}
+
+const Si4703Sim_Station *Si4703Sim::findStation(word frequency) {
+    for(byte i = 0; i < _stationCount; i++)
+        if(_stations[i].frequency == frequency) return &_stations[i];
+
+    return NULL;
+}
+
+void Si4703Sim::signal(word frequency, byte &rssi, byte &snr) {
+    //Cheap, repeatable scrambling of the frequency
+    const byte hash = ((unsigned long)frequency * 2654435761UL) >> 28;
+
+    rssi = _noiseFloor + (hash & 0x03);
+    snr = 0;
+    for(byte i = 0; i < _stationCount; i++) {
+        const int distance = abs((int)frequency - _stations[i].frequency);
+        byte r, s;
+
+        if(!distance) {
+            r = _stations[i].rssi;
+            s = r > _noiseFloor ? r - _noiseFloor : 0;
+        } else if(_stations[i].rssi >= 50 && distance <= 10) {
+            //Strong stations splatter over the adjacent channels
+            r = _stations[i].rssi - 25;
+            s = hash & 0x07;
+        } else
+            continue;
+        if(r > rssi) {
+            rssi = r;
+            snr = s;
+        };
+    };
+}
+
+bool Si4703Sim::validStop(int channel) {
+    const byte seekth = _regs[SI4703_REG_SYSCONFIG2] >> SI4703_SEEKTH_SHIFT;
+    const byte sksnr = (_regs[SI4703_REG_SYSCONFIG3] & SI4703_SKSNR_MASK) >>
+                       SI4703_SKSNR_SHIFT;
+    const byte skcnt = _regs[SI4703_REG_SYSCONFIG3] & SI4703_SKCNT_MASK;
+    byte rssi, snr;
+
+    signal(channelFrequency(channel), rssi, snr);
+    //Both SKSNR and SKCNT go from most stops at 1 to fewest stops at 15; the
+    //impulse count is modelled as falling linearly with the SNR.
+    return rssi >= seekth && (!sksnr || snr >= 3 * sksnr) &&
+           (!skcnt || (snr >= 12 ? 0 : 12 - snr) <= 16 - skcnt);
+}
+
+void Si4703Sim::applyWrite(const word *previous) {
+    if(_regs[SI4703_REG_TEST1] & SI4703_FLG_XOSCEN &&
+       !(previous[SI4703_REG_TEST1] & SI4703_FLG_XOSCEN))
+        _xoscAt = _now;
+
+    if(_regs[SI4703_REG_POWERCFG] & SI4703_FLG_ENABLE) {
+        if(_regs[SI4703_REG_POWERCFG] & SI4703_FLG_DISABLE) {
+            _power = SI4703SIM_POWER_OFF;
+            _regs[SI4703_REG_POWERCFG] &= ~SI4703_FLG_ENABLE;
+            _regs[SI4703_REG_CHIPID] = SI4703_REV_C | SI4703_DEV_SI4703_OFF |
+                                       SI4703_FIRMWARE_OFF;
+            _regs[SI4703_REG_STATUSRSSI] = 0x0000;
+            _operation = SI4703SIM_OPERATION_NONE;
+        } else if(_power == SI4703SIM_POWER_OFF) {
+            if(_regs[SI4703_REG_TEST1] & SI4703_FLG_XOSCEN &&
+               _now - _xoscAt < SI4703SIM_XOSC_MICROS)
+                _violations++;
+            _power = SI4703SIM_POWER_BOOTING;
+            _powerAt = _now + SI4703SIM_POWERUP_MICROS;
+        };
+    };
+    if(_power != SI4703SIM_POWER_ON) return;
+
+    const bool seek = _regs[SI4703_REG_POWERCFG] & SI4703_FLG_SEEK;
+    const bool tune = _regs[SI4703_REG_CHANNEL] & SI4703_FLG_TUNE;
+
+    if(_operation == SI4703SIM_OPERATION_NONE &&
+       !(_regs[SI4703_REG_STATUSRSSI] & SI4703_STATUS_STC)) {
+        if(seek && !(previous[SI4703_REG_POWERCFG] & SI4703_FLG_SEEK)) {
+            _operation = SI4703SIM_OPERATION_SEEK;
+            _seekStart = _channel;
+        } else if(tune && !(previous[SI4703_REG_CHANNEL] & SI4703_FLG_TUNE)) {
+            _operation = SI4703SIM_OPERATION_TUNE;
+            _channel = min((int)(_regs[SI4703_REG_CHANNEL] & SI4703_CHAN_MASK),
+                           channelCount());
+        };
+        if(_operation != SI4703SIM_OPERATION_NONE) {
+            _operationAt = _now + SI4703SIM_TUNE_MICROS;
+            _regs[SI4703_REG_STATUSRSSI] &= ~SI4703_STATUS_RDSR;
+            _rdsrUntil = 0;
+        };
+    } else if(_operation == SI4703SIM_OPERATION_SEEK && !seek)
+        //Seek aborted
+        _operation = SI4703SIM_OPERATION_NONE;
+
+    if(!seek && !tune)
+        _regs[SI4703_REG_STATUSRSSI] &= ~(
+            SI4703_STATUS_STC | SI4703_STATUS_SFBL);
+}
+
+void Si4703Sim::completeOperation(bool failed) {
+    //A failed wrapping seek returns to where it started
+    if(failed && !(_regs[SI4703_REG_POWERCFG] & SI4703_FLG_SKMODE))
+        _channel = _seekStart;
+    _operation = SI4703SIM_OPERATION_NONE;
+    _regs[SI4703_REG_STATUSRSSI] |= SI4703_STATUS_STC;
+    if(failed) _regs[SI4703_REG_STATUSRSSI] |= SI4703_STATUS_SFBL;
+    _regs[SI4703_REG_READCHAN] = (
+        _regs[SI4703_REG_READCHAN] & ~SI4703_READCHAN_MASK) | _channel;
+    _tunedAt = _now;
+    _groupAt = _now + SI4703SIM_RDS_SYNC_MICROS;
+    _groupIndex = 0;
+    if(_regs[SI4703_REG_SYSCONFIG1] & SI4703_FLG_STCIEN) pulseGPIO2();
+}
+
+void Si4703Sim::receiveGroup(void) {
+    const Si4703Sim_Station *station = findStation(getFrequency());
+
+    if(!(_regs[SI4703_REG_SYSCONFIG1] & SI4703_FLG_RDS) || !station ||
+       !station->pi)
+        return;
+
+    word block[4];
+    byte bler[4];
+
+    makeGroup(station, block);
+    for(byte i = 0; i < 4; i++) {
+        bler[i] = nextRandom() % 100 < _errorRate ? 1 + nextRandom() % 3 : 0;
+        //Uncorrectable errors corrupt the data
+        if(bler[i] == 3) block[i] ^= nextRandom() | 0x0001;
+        _regs[SI4703_REG_RDSA + i] = block[i];
+    };
+    _regs[SI4703_REG_STATUSRSSI] = (
+        _regs[SI4703_REG_STATUSRSSI] & ~SI4703_BLERA_MASK) | bler[0] << 9 |
+        SI4703_STATUS_RDSR;
+    _regs[SI4703_REG_READCHAN] = (
+        _regs[SI4703_REG_READCHAN] & SI4703_READCHAN_MASK) | bler[1] << 14 |
+        bler[2] << 12 | bler[3] << 10;
+    _rdsrUntil = _now + SI4703SIM_RDSR_MICROS;
+    if(_regs[SI4703_REG_SYSCONFIG1] & SI4703_FLG_RDSIEN) pulseGPIO2();
+}
+
+void Si4703Sim::makeGroup(const Si4703Sim_Station *station, word *block) {
+    block[0] = station->pi;
+    //Group reception completes at _groupAt. The first group to complete
+    //after a minute edge is 4A Clock Time, UTC: the standard puts the edge
+    //within 0.1s of the end of the group.
+    if(_groupAt % 60000000UL < SI4703SIM_RDS_GROUP_MICROS) {
+        const unsigned long minutes = SI4703SIM_EPOCH_HOUR * 60UL +
+                                      _groupAt / 60000000UL;
+        const unsigned long mjd = SI4703SIM_EPOCH_MJD + minutes / 1440;
+        const byte hour = (minutes % 1440) / 60;
+
+        block[1] = 0x4000 | ((mjd >> 15) & 0x0003);
+        block[2] = ((mjd & 0x7FFF) << 1) | (hour >> 4);
+        block[3] = ((hour & 0x0F) << 12) | ((minutes % 60) << 6);
+
+        return;
+    };
+
+    static const byte sequence[8] = { 0x00, 0x20, 0x01, 0x21, 0x02, 0x03, 0x22,
+                                      0x23 };
+    const byte entry = sequence[_groupIndex++ % 8];
+    const byte segment = entry & 0x03;
+    char text[17];
+
+    if(entry & 0x20) {
+        //2A RadioText, 4 characters per segment
+        snprintf(text, sizeof(text), "Simulated%4u.%u ",
+                 station->frequency / 100, (station->frequency % 100) / 10);
+        block[1] = 0x2000 | segment;
+        block[2] = word(text[4 * segment], text[4 * segment + 1]);
+        block[3] = word(text[4 * segment + 2], text[4 * segment + 3]);
+    } else {
+        //0A Basic tuning and switching information, music, AF list
+        byte af[6];
+
+        snprintf(text, sizeof(text), "FM%4u.%u", station->frequency / 100,
+                 (station->frequency % 100) / 10);
+        memset(af, SI4703SIM_AF_FILLER, sizeof(af));
+        af[0] = SI4703SIM_AF_NONE + station->afCount;
+        for(byte i = 0; i < station->afCount; i++)
+            af[i + 1] = (station->af[i] - 8750) / 10;
+        block[1] = 0x0008 | segment;
+        block[2] = segment == 3 ? word(af[0], af[1]) :
+            word(af[2 * segment], af[2 * segment + 1]);
+        block[3] = word(text[2 * segment], text[2 * segment + 1]);
+    };
+}
+
+void Si4703Sim::runCommand(void) {
+    const word property = _regs[SI4703_REG_RDSC];
+    byte i;
+
+    _commandPending = false;
+    switch(lowByte(_regs[SI4703_REG_RDSD])) {
+        case SI4703_CMD_VERIFY_COMMAND:
+            break;
+        case SI4703_CMD_SET_PROPERTY:
+            for(i = 0; i < SI4703SIM_MAX_PROPERTIES; i++)
+                if(_propertyIds[i] == property || !_propertyIds[i]) break;
+            if(i == SI4703SIM_MAX_PROPERTIES) {
+                _violations++;
+                break;
+            };
+            _propertyIds[i] = property;
+            _propertyValues[i] = _regs[SI4703_REG_RDSA];
+            break;
+        case SI4703_CMD_GET_PROPERTY:
+            //A measurement, not a setting
+            if(property == SI4703_PROP_SNRDB) {
+                byte rssi, snr;
+
+                signal(channelFrequency(_channel), rssi, snr);
+                _regs[SI4703_REG_RDSA] = snr;
+            } else
+                _regs[SI4703_REG_RDSA] = getProperty(property);
+            break;
+        default:
+            _violations++;
+    };
+    _regs[SI4703_REG_RDSD] &= 0xFF00;
+}
+
+void Si4703Sim::pulseGPIO2(void) {
+    if((_regs[SI4703_REG_SYSCONFIG1] & SI4703_GPIO2_MASK) != SI4703_GPIO2_INT)
+        return;
+
+    if(!_gpio2Until) _edge = true;
+    _gpio2Until = _now + SI4703SIM_GPIO2_MICROS;
+}
+
+word Si4703Sim::nextRandom(void) {
+    _random = _random * 1103515245UL + 12345;
+
+    return _random >> 16;
+}
+
+void Si4703Sim::refreshStatus(void) {
+    word status = _regs[SI4703_REG_STATUSRSSI] & (
+        SI4703_STATUS_RDSR | SI4703_STATUS_STC | SI4703_STATUS_SFBL |
+        SI4703_BLERA_MASK);
+
+    if(_power == SI4703SIM_POWER_ON &&
+       _operation == SI4703SIM_OPERATION_NONE) {
+        const Si4703Sim_Station *station = findStation(getFrequency());
+        byte rssi, snr;
+
+        signal(getFrequency(), rssi, snr);
+        //A little fading, repeatable and independent of the bus traffic
+        rssi += (_now / 100000UL) % 3;
+        status |= rssi;
+        if(snr < 3) status |= SI4703_STATUS_AFCRL;
+        if(station && station->stereo && rssi >= 20 &&
+           !(_regs[SI4703_REG_POWERCFG] & SI4703_FLG_MONO))
+            status |= SI4703_STATUS_ST;
+        if(station && station->pi &&
+           _regs[SI4703_REG_SYSCONFIG1] & SI4703_FLG_RDS &&
+           _now - _tunedAt >= SI4703SIM_RDS_SYNC_MICROS)
+            status |= SI4703_STATUS_RDSS;
+    };
+    _regs[SI4703_REG_STATUSRSSI] = status;
+}
+
+bool Si4703Sim::play(const byte *trace, size_t length) {
+    Si4703_TraceRecord record;
+    size_t reads = 0, writes = 0;
+
+    stopPlaying();
+    for(size_t at = 0, used; at < length; at += used) {
+        used = Si4703Trace::decode(trace + at, length - at, record);
+        if(!used) return false;
+        if(record.type == SI4703_TRACE_READ) reads++;
+        else if(record.type == SI4703_TRACE_WRITE) writes++;
+    };
+    if(!reads) return false;
+
+    //At most one event per read and one start per write
+    _snapshots = new Si4703Sim_Snapshot[reads];
+    _events = new unsigned long[reads];
+    _starts = new unsigned long[writes];
+
+    word written[SI4703_LAST_REGISTER + 1], state[SI4703_LAST_REGISTER + 1];
+    word group[4], valid = 0x0000, completion = 0x0000;
+    unsigned long stamp = 0, interrupt = 0, arrived = 0;
+    bool interrupted = false;
+
+    memset(written, 0x00, sizeof(written));
+    memset(state, 0x00, sizeof(state));
+    memset(group, 0x00, sizeof(group));
+    for(size_t at = 0; at < length; ) {
+        at += Si4703Trace::decode(trace + at, length - at, record);
+        stamp += record.delta;
+        //Nothing useful came back
+        if(record.nack) continue;
+
+        if(record.type == SI4703_TRACE_INTERRUPT) {
+            interrupt = stamp;
+            interrupted = true;
+        } else if(record.type == SI4703_TRACE_WRITE) {
+            word previous[SI4703_LAST_REGISTER + 1];
+
+            memcpy(previous, written, sizeof(written));
+            for(byte i = 0; i < record.count; i++)
+                written[SI4703_FIRST_REGISTER_WRITE + i] =
+                    record.registers[SI4703_FIRST_REGISTER_WRITE + i];
+            if(classifyWrite(previous, written)) {
+                _starts[_startCount++] = stamp;
+                //STC may not have been seen to go down in between
+                completion = 0x0000;
+            };
+        } else {
+            const unsigned long when = interrupted ? interrupt : stamp;
+            bool event = false;
+
+            for(byte i = 0; i < record.count; i++) {
+                const byte reg = (SI4703_FIRST_REGISTER_READ + i) &
+                                 SI4703_LAST_REGISTER;
+
+                state[reg] = record.registers[reg];
+                valid |= bit(reg);
+            };
+            //Only whole groups count, and a group is new if it is different
+            //or came after the last one had to be gone
+            if(state[SI4703_REG_STATUSRSSI] & SI4703_STATUS_RDSR &&
+               record.count >= SI4703_REG_RDSD - SI4703_REG_STATUSRSSI + 1 &&
+               (memcmp(group, &state[SI4703_REG_RDSA], sizeof(group)) ||
+                when - arrived >= SI4703SIM_RDSR_MICROS)) {
+                memcpy(group, &state[SI4703_REG_RDSA], sizeof(group));
+                arrived = when;
+                event = true;
+            };
+            if(state[SI4703_REG_STATUSRSSI] & SI4703_STATUS_STC &&
+               !(completion & SI4703_STATUS_STC))
+                event = true;
+            completion |= state[SI4703_REG_STATUSRSSI] & (
+                SI4703_STATUS_STC | SI4703_STATUS_SFBL);
+            if(event) _events[_eventCount++] = when;
+            interrupted = false;
+
+            Si4703Sim_Snapshot &snapshot = _snapshots[_snapshotCount++];
+
+            snapshot.stamp = stamp;
+            snapshot.arrived = arrived;
+            snapshot.valid = valid;
+            snapshot.completion = completion;
+            memcpy(snapshot.regs, state, sizeof(state));
+        };
+    };
+    _offset = _now;
+    _startedAt = 0;
+    _completion = 0x0000;
+    _nextEvent = _nextStart = 0;
+
+    return true;
+}
+
+byte Si4703Sim::classifyWrite(const word *previous, const word *current) {
+    const word powered = SI4703_FLG_ENABLE | SI4703_FLG_DISABLE;
+
+    if((current[SI4703_REG_POWERCFG] & powered) == SI4703_FLG_ENABLE &&
+       (previous[SI4703_REG_POWERCFG] & powered) != SI4703_FLG_ENABLE)
+        return SI4703SIM_START_POWERUP;
+    if(current[SI4703_REG_POWERCFG] & SI4703_FLG_SEEK &&
+       !(previous[SI4703_REG_POWERCFG] & SI4703_FLG_SEEK))
+        return SI4703SIM_START_SEEK;
+    if(current[SI4703_REG_CHANNEL] & SI4703_FLG_TUNE &&
+       !(previous[SI4703_REG_CHANNEL] & SI4703_FLG_TUNE))
+        return SI4703SIM_START_TUNE;
+
+    return SI4703SIM_START_NONE;
+}
+
+void Si4703Sim::stopPlaying(void) {
+    delete[] _snapshots;
+    delete[] _events;
+    delete[] _starts;
+    _snapshots = NULL;
+    _events = _starts = NULL;
+    _snapshotCount = _eventCount = _startCount = 0;
+}
+
+void Si4703Sim::playStatus(void) {
+    const unsigned long now = _now - _offset;
+    size_t low = 0, high = _snapshotCount;
+
+    //Last snapshot taken at or before now
+    while(low < high) {
+        const size_t middle = (low + high) / 2;
+
+        if(_snapshots[middle].stamp <= now) low = middle + 1;
+        else high = middle;
+    };
+    if(!low) return;
+
+    const Si4703Sim_Snapshot &snapshot = _snapshots[low - 1];
+
+    //The driver's own writes are read back as they are
+    for(byte reg = 0; reg <= SI4703_LAST_REGISTER; reg++)
+        if(snapshot.valid & bit(reg) &&
+           (reg < SI4703_FIRST_REGISTER_WRITE ||
+            reg >= SI4703_FIRST_REGISTER_READ))
+            _regs[reg] = snapshot.regs[reg];
+    //STC is the driver's to clear, whenever the traced one did; what the
+    //traced one saw before this operation started is of no concern.
+    if(snapshot.stamp >= _startedAt) _completion |= snapshot.completion;
+    if(!(_regs[SI4703_REG_POWERCFG] & SI4703_FLG_SEEK) &&
+       !(_regs[SI4703_REG_CHANNEL] & SI4703_FLG_TUNE))
+        _completion = 0x0000;
+    _regs[SI4703_REG_STATUSRSSI] = (_regs[SI4703_REG_STATUSRSSI] & ~(
+        SI4703_STATUS_STC | SI4703_STATUS_SFBL)) | _completion;
+    //Or be looking later than the traced one did
+    if(now - snapshot.arrived >= SI4703SIM_RDSR_MICROS)
+        _regs[SI4703_REG_STATUSRSSI] &= ~SI4703_STATUS_RDSR;
+}
+
+void Si4703Sim::alignPlayback(void) {
+    if(_nextStart == _startCount) return;
+
+    _startedAt = _starts[_nextStart++];
+    _offset = _now - _startedAt;
+    _completion = 0x0000;
+
+    const unsigned long now = _now - _offset;
+
+    while(_nextEvent && _events[_nextEvent - 1] > now) _nextEvent--;
+    while(_nextEvent < _eventCount && _events[_nextEvent] <= now)
+        _nextEvent++;
+}
@@ -0,0 +1,275 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This file is part of the host build, see the README for details.
+ *
+ * It describes a behavioral model of the Si4703: the register file with its
+ * sequential I2C access rules, power-up and oscillator timing, seek/tune with
+ * STC and SF/BL, RDS group reception with block errors, the GPIO2 interrupt
+ * output and the command processor. The same chip can instead play back a
+ * trace recorded by Si4703Trace. It also exposes the knobs of the host
+ * stand-ins for the Arduino core and Wire library.
+ */
+
+#ifndef _SI4703SIM_H_INCLUDED
+#define _SI4703SIM_H_INCLUDED
+
+#include <Arduino.h>
+#include <Si4703.h>
+#include <Si4703Trace.h>
+
+//Chips on the simulated bus, behind an I2C mux, see Si4703Host_selectBus()
+#define SI4703SIM_CHIPS 2
+
+#define SI4703SIM_MAX_STATIONS 16
+#define SI4703SIM_MAX_AF 4
+#define SI4703SIM_MAX_PROPERTIES 8
+
+//Timings from the Si4702/03 datasheet, in microseconds
+#define SI4703SIM_XOSC_MICROS 500000UL
+#define SI4703SIM_POWERUP_MICROS 110000UL
+#define SI4703SIM_TUNE_MICROS 60000UL
+#define SI4703SIM_GPIO2_MICROS 5000UL
+#define SI4703SIM_RDSR_MICROS 40000UL
+//Derived from the 1187.5bps RDS bit rate and 104 bits per group
+#define SI4703SIM_RDS_GROUP_MICROS 87579UL
+//Not specified by the datasheet, picked to be plausible
+#define SI4703SIM_RDS_SYNC_MICROS 200000UL
+#define SI4703SIM_COMMAND_MICROS 1000UL
+
+//What a write asks the chip to start, see Si4703Sim::classifyWrite()
+#define SI4703SIM_START_NONE 0
+#define SI4703SIM_START_POWERUP 1
+#define SI4703SIM_START_TUNE 2
+#define SI4703SIM_START_SEEK 3
+
+//Wall clock broadcast in RDS group 4A when the simulated time is zero
+#define SI4703SIM_EPOCH_MJD 60000UL
+#define SI4703SIM_EPOCH_HOUR 12
+
+typedef struct {
+    word frequency;
+    byte rssi;
+    bool stereo;
+    word pi;
+    byte afCount;
+    word af[SI4703SIM_MAX_AF];
+} Si4703Sim_Station;
+
+//What the traced chip answered, see Si4703Sim::play()
+typedef struct {
+    unsigned long stamp;
+    //When the RDS group in there came in
+    unsigned long arrived;
+    //Registers read at least once by then
+    word valid;
+    //STC and SF/BL, if seen since the last tune or seek started
+    word completion;
+    word regs[SI4703_LAST_REGISTER + 1];
+} Si4703Sim_Snapshot;
+
+typedef struct {
+    unsigned long transactions;
+    unsigned long bytes;
+    unsigned long micros;
+} Si4703Sim_BusStats;
+
+class Si4703Sim
+{
+    public:
+        Si4703Sim(void);
+
+        /*
+        * Description:
+        *   Forgets all stations and properties and power cycles the chip.
+        */
+        void clear(void);
+
+        /*
+        * Description:
+        *   Returns the chip to its power-on state, keeping the configured
+        *   stations. Must be called whenever the simulated clock is reset.
+        */
+        void powerCycle(void);
+
+        /*
+        * Description:
+        *   Describes the RF environment the chip is listening to.
+        * Parameters:
+        *   frequency - in 10kHz units, like Si4703::getFrequency().
+        *   rssi      - in dBuV.
+        *   pi        - RDS Program Identification code, zero for a station
+        *               that does not transmit RDS.
+        */
+        bool addStation(word frequency, byte rssi, bool stereo = true,
+                        word pi = 0x0000);
+        bool addAlternativeFrequency(word frequency, word af);
+        //Changes the signal of a station, e.g. to drive out of its coverage
+        bool setStationRSSI(word frequency, byte rssi);
+        void setNoiseFloor(byte rssi) { _noiseFloor = rssi; };
+        void setBlockErrorRate(byte percent) { _errorRate = percent; };
+        //The next count transactions are not acknowledged, as on a noisy bus
+        void failTransactions(byte count) { _failures = count; };
+
+        /*
+        * Description:
+        *   Wiring of the chip to the (simulated) MCU.
+        */
+        void setPins(byte pinReset, byte pinGPIO2) {
+            _pinReset = pinReset; _pinGPIO2 = pinGPIO2; };
+        byte getGPIO2Pin(void) { return _pinGPIO2; };
+        void setPin(byte pin, byte level);
+        byte getPin(byte pin);
+
+        /*
+        * Description:
+        *   Sequential I2C access, writes start at POWERCFG and reads start at
+        *   STATUSRSSI, both wrapping around at 0x0F. Return false if the chip
+        *   would not have acknowledged the transaction.
+        */
+        bool write(const byte *data, byte count);
+        bool read(byte *data, byte count);
+
+        /*
+        * Description:
+        *   Advances the model to absolute time now, in microseconds.
+        */
+        void update(unsigned long now);
+
+        /*
+        * Description:
+        *   Plays back a trace recorded by Si4703Trace instead of modelling
+        *   the chip: reads return what the traced chip answered at the same
+        *   point in the trace and GPIO2 pulses when the traced chip raised
+        *   STC or received an RDS group (at the traced interrupt, if any).
+        *   The trace clock is lined up again with every power-up, tune and
+        *   seek the driver starts, so that each of them takes as long as it
+        *   did when traced, however late the driver starts it. Registers
+        *   the driver writes read back as written; the command processor is
+        *   not played back. Stations are ignored until clear().
+        * Returns:
+        *   false if the trace does not decode or has no reads in it.
+        */
+        bool play(const byte *trace, size_t length);
+        //Where in the trace playback is, in microseconds from its start
+        unsigned long getPlaybackTime(void) { return _now - _offset; };
+
+        /*
+        * Description:
+        *   Tells what a write starts: one of the SI4703SIM_START_* constants.
+        * Parameters:
+        *   previous, current - the writable registers before and after it.
+        */
+        static byte classifyWrite(const word *previous, const word *current);
+
+        /*
+        * Description:
+        *   Returns true (once) if GPIO2 had a falling edge since the last call.
+        */
+        bool takeEdge(void);
+
+        word getRegister(byte reg) { return _regs[reg & SI4703_LAST_REGISTER]; };
+        word getFrequency(void) { return channelFrequency(_channel); };
+        word getProperty(word property);
+        bool isMuted(void);
+
+        /*
+        * Description:
+        *   Number of times the driver broke the datasheet rules (talking to
+        *   the chip in reset, powering up before the oscillator settled, etc.)
+        */
+        unsigned long getViolations(void) { return _violations; };
+
+    private:
+        word _regs[SI4703_LAST_REGISTER + 1];
+        unsigned long _now;
+        byte _pinReset, _pinGPIO2;
+        bool _inReset;
+        byte _power;
+        unsigned long _powerAt, _xoscAt;
+        byte _operation;
+        int _channel, _seekStart;
+        unsigned long _operationAt, _tunedAt, _groupAt, _rdsrUntil,
+                      _gpio2Until, _commandAt;
+        bool _edge, _commandPending;
+        word _groupIndex;
+        Si4703Sim_Station _stations[SI4703SIM_MAX_STATIONS];
+        byte _stationCount;
+        word _propertyIds[SI4703SIM_MAX_PROPERTIES];
+        word _propertyValues[SI4703SIM_MAX_PROPERTIES];
+        byte _noiseFloor, _errorRate, _failures;
+        unsigned long _random;
+        unsigned long _violations;
+        //Playback, see play()
+        Si4703Sim_Snapshot *_snapshots;
+        unsigned long *_events, *_starts;
+        size_t _snapshotCount, _eventCount, _startCount, _nextEvent,
+               _nextStart;
+        //Playback time is simulated time minus _offset, and the operation
+        //being played back started at _startedAt in playback time
+        unsigned long _offset, _startedAt;
+        //STC and SF/BL as last seen for that operation
+        word _completion;
+
+        word bandBottom(void);
+        word bandTop(void);
+        byte spacing(void);
+        int channelCount(void);
+        word channelFrequency(int channel);
+        const Si4703Sim_Station *findStation(word frequency);
+        void signal(word frequency, byte &rssi, byte &snr);
+        bool validStop(int channel);
+        void applyWrite(const word *previous);
+        void completeOperation(bool failed);
+        void receiveGroup(void);
+        void makeGroup(const Si4703Sim_Station *station, word *block);
+        void runCommand(void);
+        void pulseGPIO2(void);
+        word nextRandom(void);
+        void refreshStatus(void);
+        void stopPlaying(void);
+        void playStatus(void);
+        void alignPlayback(void);
+};
+
+extern Si4703Sim Si4703_Simulators[SI4703SIM_CHIPS];
+//The first of the above, the only one that matters unless a mux is used
+extern Si4703Sim &Si4703_Simulator;
+extern Si4703Sim_BusStats Si4703_HostBus;
+
+/*
+* Description:
+*   Resets the simulated clock, the bus statistics and the interrupt
+*   controller, then power cycles the simulated chip.
+*/
+void Si4703Host_reset(void);
+
+/*
+* Description:
+*   Lets the simulated time run for us microseconds, delivering GPIO2
+*   interrupts along the way.
+*/
+void Si4703Host_advance(unsigned long us);
+
+/*
+* Description:
+*   A Si4703_BusSelector standing in for an I2C mux with one simulated chip
+*   on each channel. Selection is free, no bus traffic is accounted for it.
+*/
+void Si4703Host_selectBus(byte bus);
+
+/*
+* Description:
+*   One whole I2C transaction with the simulated chip on the selected bus,
+*   accounted for in Si4703_HostBus and taking as long in simulated time as
+*   it would on a real bus at Wire's clock. Used by Wire and, bypassing it,
+*   by Si4703_SimTransport.
+* Returns:
+*   false if the address was not acknowledged.
+*/
+bool Si4703Host_read(byte address, byte *data, byte count);
+bool Si4703Host_write(byte address, const byte *data, byte count);
+
+#endif
@@ -0,0 +1,55 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This file is part of the host build, see the README for details.
+ *
+ * It stands in for the Arduino Wire library: every transaction is handed to
+ * the simulated Si4703 through Si4703Host_read()/Si4703Host_write(), see
+ * Si4703Sim.h.
+ */
+
+#ifndef _WIRE_H_INCLUDED
+#define _WIRE_H_INCLUDED
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH 32
+
+class TwoWire
+{
+    public:
+        TwoWire(void);
+
+        /*
+        * Description:
+        *   Unlike the AVR implementation, begin() leaves the bus clock alone
+        *   so that it can be chosen before the code under test starts.
+        */
+        void begin(void) {};
+        void setClock(uint32_t clock) { _clock = clock; };
+        uint32_t getClock(void) { return _clock; };
+
+        void beginTransmission(uint8_t address);
+        void beginTransmission(int address) {
+            beginTransmission((uint8_t)address); };
+        size_t write(uint8_t data);
+        uint8_t endTransmission(bool stop = true);
+
+        uint8_t requestFrom(uint8_t address, uint8_t quantity);
+        uint8_t requestFrom(int address, int quantity) {
+            return requestFrom((uint8_t)address, (uint8_t)quantity); };
+        int available(void) { return _rxLength - _rxIndex; };
+        int read(void);
+
+    private:
+        uint32_t _clock;
+        uint8_t _address;
+        uint8_t _txBuffer[BUFFER_LENGTH], _txLength;
+        uint8_t _rxBuffer[BUFFER_LENGTH], _rxLength, _rxIndex;
+};
+
+extern TwoWire Wire;
+
+#endif
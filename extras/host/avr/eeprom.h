@@ -0,0 +1,27 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This file is part of the host build, see the README for details.
+ *
+ * It stands in for avr-libc's <avr/eeprom.h> with 1KiB of simulated EEPROM
+ * (an ATmega328P's worth) that counts the bytes actually written.
+ */
+
+#ifndef _AVR_EEPROM_H_INCLUDED
+#define _AVR_EEPROM_H_INCLUDED
+
+#include <Arduino.h>
+
+#define E2END 0x3FF
+
+//Cells programmed since the last Si4703Host_reset(), unchanged ones excluded
+extern unsigned long Si4703Host_eepromWrites;
+
+uint8_t eeprom_read_byte(const uint8_t *address);
+void eeprom_update_byte(uint8_t *address, uint8_t value);
+void eeprom_read_block(void *destination, const void *source, size_t count);
+void eeprom_update_block(const void *source, void *destination, size_t count);
+
+#endif
@@ -0,0 +1,30 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This file is part of the host build, see the README for details.
+ *
+ * It stands in for avr-libc's <avr/interrupt.h>, as far as the pin change
+ * vectors of the ATmega328P go. Vectors nobody defined are left null and
+ * never raised.
+ */
+
+#ifndef _AVR_INTERRUPT_H_INCLUDED
+#define _AVR_INTERRUPT_H_INCLUDED
+
+#include <Arduino.h>
+
+#define ISR(vector) extern "C" void vector(void)
+
+#define PCINT0_vect Si4703Host_PCINT0
+#define PCINT1_vect Si4703Host_PCINT1
+#define PCINT2_vect Si4703Host_PCINT2
+
+extern "C" {
+    void Si4703Host_PCINT0(void) __attribute__((weak));
+    void Si4703Host_PCINT1(void) __attribute__((weak));
+    void Si4703Host_PCINT2(void) __attribute__((weak));
+}
+
+#endif
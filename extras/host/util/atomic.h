@@ -0,0 +1,45 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This file is part of the host build, see the README for details.
+ *
+ * It stands in for avr-libc's <util/atomic.h> on top of the simulated global
+ * interrupt flag.
+ */
+
+#ifndef _UTIL_ATOMIC_H_INCLUDED
+#define _UTIL_ATOMIC_H_INCLUDED
+
+#include <Arduino.h>
+
+bool Si4703Host_interruptsEnabled(void);
+
+class Si4703Host_InterruptGuard
+{
+    public:
+        Si4703Host_InterruptGuard(bool enable) : _done(false) {
+            _saved = Si4703Host_interruptsEnabled();
+            if(enable) interrupts(); else noInterrupts();
+        };
+        ~Si4703Host_InterruptGuard() {
+            if(_saved) interrupts(); else noInterrupts();
+        };
+        bool once(void) { return !_done && (_done = true); };
+
+    private:
+        bool _saved, _done;
+};
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define NONATOMIC_RESTORESTATE
+#define NONATOMIC_FORCEOFF
+
+#define ATOMIC_BLOCK(type) \
+    for(Si4703Host_InterruptGuard _guard(false); _guard.once(); )
+#define NONATOMIC_BLOCK(type) \
+    for(Si4703Host_InterruptGuard _guard(true); _guard.once(); )
+
+#endif
@@ -0,0 +1,25 @@
+/* Arduino Si4703 (and family) Library
+ * See the README file for author and licensing information. In case it's
+ * missing from your distribution, use the one here as the authoritative
+ * version: https://github.com/csdexter/Si4703/blob/master/README
+ *
+ * This file is part of the host build, see the README for details.
+ *
+ * It stands in for the part of avr-libc's <util/crc16.h> used by the library.
+ */
+
+#ifndef _UTIL_CRC16_H_INCLUDED
+#define _UTIL_CRC16_H_INCLUDED
+
+#include <stdint.h>
+
+//CRC-8 with the x^8 + x^2 + x + 1 polynomial, as in avr-libc
+static inline uint8_t _crc8_ccitt_update(uint8_t crc, uint8_t data) {
+    crc ^= data;
+    for(uint8_t i = 0; i < 8; i++)
+        crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+
+    return crc;
+}
+
+#endif